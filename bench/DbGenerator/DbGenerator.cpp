@@ -0,0 +1,371 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "DbGenerator.h"
+#include <QtSql>
+#include <QtEndian>
+#include <QtZlib/zlib.h>
+#include "ProfileItem/ProfileItem.h"
+#include "TreeItem/TreeItem.h"
+
+static const char *connectionName = "DbGenerator";
+
+// Records inserted in one transaction
+static const int commitInterval = 5000;
+
+static const char *schema[] = {
+    "CREATE TABLE FOLDERS ("
+    " ID INTEGER NOT NULL PRIMARY KEY,"
+    " PARENTID INTEGER,"
+    " FOLDERNAME VARCHAR(255));",
+
+    "CREATE TABLE DATA ("
+    " ID INTEGER NOT NULL PRIMARY KEY,"
+    " FOLDERID INTEGER,"
+    " MODULENAME VARCHAR(255),"
+    " KIND INTEGER,"
+    " DATASIZE INTEGER,"
+    " CREATEDDATE TIMESTAMP,"
+    " DATA BLOB SUB_TYPE 0,"
+    " PROFILE BLOB SUB_TYPE 0);",
+
+    "CREATE INDEX FOLDERS_PARENTID ON FOLDERS (PARENTID);",
+    "CREATE INDEX DATA_FOLDERID ON DATA (FOLDERID);"
+};
+
+static void appendInt32(QByteArray *out, qint32 value)
+{
+    char buf[sizeof(qint32)];
+    qToLittleEndian<qint32>(value, buf);
+    out->append(buf, sizeof(buf));
+}
+
+static void appendInt16(QByteArray *out, qint16 value)
+{
+    char buf[sizeof(qint16)];
+    qToLittleEndian<qint16>(value, buf);
+    out->append(buf, sizeof(buf));
+}
+
+static void appendDouble(QByteArray *out, double value)
+{
+    out->append((const char *)&value, sizeof(double));
+}
+
+static void appendText(QByteArray *out, const QByteArray &text)
+{
+    appendInt32(out, text.size());
+    out->append(text);
+}
+
+static double toTDateTime(const QDateTime &dateTime)
+{
+    // Inverse of fromTDateTime() in ProfileItem.cpp
+    return dateTime.toSecsSinceEpoch() / 86400.0 + 25569.0;
+}
+
+DbGenerator::DbGenerator(const Shape &shape) :
+    m_shape(shape),
+    m_random(shape.seed)
+{
+    if (m_shape.folders <= 0)
+        m_shape.folders = qMax(1, m_shape.records / 200);
+}
+
+bool DbGenerator::generate(const QString &path)
+{
+    if (QFile::exists(path) && !QFile::remove(path)) {
+        m_lastErrorMsg = "Can't remove old database file " + path;
+        return false;
+    }
+
+    if (!createDatabase(path))
+        return false;
+
+    return fillDatabase(path);
+}
+
+QByteArray DbGenerator::packData(const QByteArray &data, int level)
+{
+    uLongf length = compressBound(data.size());
+
+    // 32-bit length prefix followed by zlib stream, as SqlCore::rawData expects
+    QByteArray out(sizeof(quint32) + length, Qt::Uninitialized);
+    qToLittleEndian<quint32>(data.size(), out.data());
+
+    int err = compress2((uchar *)out.data() + sizeof(quint32),
+                        &length,
+                        (const uchar *)data.constData(),
+                        data.size(),
+                        level);
+    if (err != Z_OK)
+        return QByteArray();
+
+    out.resize(sizeof(quint32) + length);
+    return out;
+}
+
+QByteArray DbGenerator::makeProfile(const QList<QPair<QString, QVariant>> &items)
+{
+    QByteArray out;
+
+    // Header, see raw_profile_header_part_1_t & raw_profile_header_part_2_t
+    out.append("\x01\x00\x00", 3);
+    appendText(&out, "root");
+    appendInt32(&out, items.count());
+    appendInt32(&out, 0);
+
+    for (int i = 0; i < items.count(); i++) {
+        const QString &parameter = items.at(i).first;
+        const QVariant &value = items.at(i).second;
+
+        // Item number
+        appendText(&out, QByteArray::number(i + 1));
+
+        // Item parameter, see raw_profile_item_part_2_t
+        appendInt32(&out, 0x00000000);
+        appendInt32(&out, 0x00000002);
+        appendInt32(&out, 0x00000001);
+        out.append("\x4E\x08\x00", 3);
+        appendText(&out, parameter.toLocal8Bit());
+
+        // Parameter type, see raw_profile_item_part_3_t
+        appendInt32(&out, 0x00000001);
+        switch (value.type()) {
+        case QVariant::UInt:
+        case QVariant::Int:
+            appendInt16(&out, ParameterType::Integer);
+            out.append('\0');
+            appendInt32(&out, value.toUInt());
+            break;
+        case QVariant::Double:
+            appendInt16(&out, ParameterType::Double);
+            out.append('\0');
+            appendDouble(&out, value.toDouble());
+            break;
+        case QVariant::DateTime:
+            appendInt16(&out, ParameterType::Date);
+            out.append('\0');
+            appendDouble(&out, toTDateTime(value.toDateTime()));
+            break;
+        case QVariant::Bool:
+            appendInt16(&out, ParameterType::Boolean);
+            out.append('\0');
+            out.append(value.toBool() ? '\1' : '\0');
+            break;
+        default:
+            appendInt16(&out, ParameterType::String);
+            out.append('\0');
+            appendText(&out, value.toString().toLocal8Bit());
+        }
+    }
+
+    return out;
+}
+
+bool DbGenerator::createDatabase(const QString &path)
+{
+    QString isql = qEnvironmentVariable("ISQL");
+    if (isql.isEmpty())
+        isql = QStandardPaths::findExecutable("isql-fb");
+    if (isql.isEmpty())
+        isql = QStandardPaths::findExecutable("isql");
+    if (isql.isEmpty()) {
+        m_lastErrorMsg = "Firebird isql tool not found, set ISQL environment variable";
+        return false;
+    }
+
+    QTemporaryFile script;
+    if (!script.open()) {
+        m_lastErrorMsg = "Can't create isql script file";
+        return false;
+    }
+
+    QTextStream ts(&script);
+    ts << QString("CREATE DATABASE '%1' USER 'SYSDBA' PASSWORD 'masterkey' PAGE_SIZE 4096;\n")
+              .arg(QDir::toNativeSeparators(QFileInfo(path).absoluteFilePath()));
+    for (const char *statement : schema)
+        ts << statement << "\n";
+    ts << "COMMIT;\n";
+    ts.flush();
+    script.close();
+
+    QProcess process;
+    process.start(isql, QStringList() << "-q" << "-i" << script.fileName());
+    if (!process.waitForFinished(-1) || (process.exitCode() != 0)) {
+        m_lastErrorMsg = QString("isql failed: %1").arg(QString::fromLocal8Bit(process.readAllStandardError()));
+        return false;
+    }
+
+    return true;
+}
+
+bool DbGenerator::fillDatabase(const QString &path)
+{
+    bool ok = true;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QIBASE", connectionName);
+        db.setDatabaseName(QFileInfo(path).absoluteFilePath());
+        db.setUserName("SYSDBA");
+        db.setPassword("masterkey");
+
+        if (!db.open()) {
+            m_lastErrorMsg = db.lastError().databaseText();
+            ok = false;
+        }
+
+        // Folders: each one is attached to a random folder created before,
+        // nesting level is limited by shape depth
+        QVector<int> levels;
+        if (ok) {
+            db.transaction();
+
+            QSqlQuery query(db);
+            query.prepare("INSERT INTO FOLDERS (ID, PARENTID, FOLDERNAME) VALUES (?, ?, ?)");
+
+            for (int id = 1; ok && (id <= m_shape.folders); id++) {
+                int parentId = 0;
+                int level = 0;
+                if (!levels.isEmpty()) {
+                    int candidate = m_random.bounded(levels.count() + 1); // 0 means root
+                    if ((candidate > 0) && (levels.at(candidate - 1) < m_shape.depth - 1)) {
+                        parentId = candidate;
+                        level = levels.at(candidate - 1) + 1;
+                    }
+                }
+                levels.append(level);
+
+                query.addBindValue(id);
+                query.addBindValue(parentId);
+                query.addBindValue(QString("Folder %1").arg(id));
+                if (!query.exec()) {
+                    m_lastErrorMsg = query.lastError().databaseText();
+                    ok = false;
+                }
+            }
+
+            if (ok)
+                db.commit();
+            else
+                db.rollback();
+        }
+
+        // Records, spread evenly over all folders
+        if (ok) {
+            db.transaction();
+
+            QSqlQuery query(db);
+            query.prepare("INSERT INTO DATA (ID, FOLDERID, MODULENAME, KIND, DATASIZE, CREATEDDATE, DATA, PROFILE) "
+                          "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+
+            const QDateTime epoch(QDate(2015, 1, 1), QTime(0, 0), Qt::UTC);
+
+            for (int id = 1; ok && (id <= m_shape.records); id++) {
+                int folderId = m_random.bounded(m_shape.folders) + 1;
+                int type = m_random.bounded(TreeItem::InternalData + 1);
+                int size = m_shape.minSize + m_random.bounded(m_shape.maxSize - m_shape.minSize + 1);
+                if ((int)m_random.bounded(100) < m_shape.largePercent)
+                    size = m_shape.maxSize + m_random.bounded(qMax(1, m_shape.largeSize - m_shape.maxSize));
+                QDateTime ctime = epoch.addSecs(m_random.bounded(10 * 365 * 86400));
+
+                QString name = QString("module_%1.%2")
+                                   .arg(id, 8, 10, QChar('0'))
+                                   .arg(type == TreeItem::Text ? "txt" : "bin");
+
+                query.addBindValue(id);
+                query.addBindValue(folderId);
+                query.addBindValue(name);
+                query.addBindValue(type);
+                query.addBindValue(size);
+                query.addBindValue(ctime);
+                query.addBindValue(packData(makeData(size, type)));
+                query.addBindValue(makeRecordProfile(id, size, ctime));
+                if (!query.exec()) {
+                    m_lastErrorMsg = query.lastError().databaseText();
+                    ok = false;
+                }
+
+                if (ok && (id % commitInterval == 0)) {
+                    db.commit();
+                    db.transaction();
+                }
+            }
+
+            if (ok)
+                db.commit();
+            else
+                db.rollback();
+        }
+
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+QByteArray DbGenerator::makeData(int size, int type)
+{
+    QByteArray out(size, Qt::Uninitialized);
+
+    if (type == TreeItem::Text) {
+        // Log-like text lines
+        int offset = 0;
+        int line = 0;
+        while (offset < size) {
+            QByteArray text = QString("%1: LBA %2, status 0x%3, retries %4\r\n")
+                                  .arg(line++, 6, 10, QChar('0'))
+                                  .arg(m_random.bounded(1 << 30))
+                                  .arg(m_random.bounded(256), 2, 16, QChar('0'))
+                                  .arg(m_random.bounded(4))
+                                  .toLatin1();
+            int n = qMin(text.size(), size - offset);
+            memcpy(out.data() + offset, text.constData(), n);
+            offset += n;
+        }
+        return out;
+    }
+
+    // Firmware-like binary: mix of random code, zero & 0xFF padding and tables
+    const int block = 512;
+    for (int offset = 0; offset < size; offset += block) {
+        int n = qMin(block, size - offset);
+        uchar *p = (uchar *)out.data() + offset;
+        switch (m_random.bounded(4)) {
+        case 0:
+            for (int i = 0; i < n; i++)
+                p[i] = (uchar)m_random.bounded(256);
+            break;
+        case 1:
+            memset(p, 0x00, n);
+            break;
+        case 2:
+            memset(p, 0xFF, n);
+            break;
+        default:
+            for (int i = 0; i < n; i++)
+                p[i] = (uchar)(i & 0x3F);
+        }
+    }
+
+    return out;
+}
+
+QByteArray DbGenerator::makeRecordProfile(int id, int size, const QDateTime &ctime)
+{
+    QList<QPair<QString, QVariant>> items;
+    items << qMakePair(QString("Model"), QVariant(QString("ST%1DM00%2").arg(250 * (1 + id % 16)).arg(id % 8)))
+          << qMakePair(QString("Firmware"), QVariant(QString("CC%1").arg(40 + id % 20)))
+          << qMakePair(QString("Serial"), QVariant(QString("Z%1").arg(id, 7, 36, QChar('0')).toUpper()))
+          << qMakePair(QString("Size"), QVariant((uint)size))
+          << qMakePair(QString("Temperature"), QVariant(20.0 + (id % 300) / 10.0))
+          << qMakePair(QString("Date"), QVariant(ctime))
+          << qMakePair(QString("Checked"), QVariant(id % 2 == 0));
+    return makeProfile(items);
+}
@@ -0,0 +1,50 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef DBGENERATOR_H
+#define DBGENERATOR_H
+
+#include <QtCore>
+
+// Builds synthetic ACE-style databases (FOLDERS/DATA tables) for benchmarks.
+// Database file is created by Firebird "isql" tool, then filled over QIBASE.
+class DbGenerator
+{
+public:
+    struct Shape {
+        int records = 1000;         // Number of DATA records
+        int folders = 0;            // Number of FOLDERS records, 0 = records / 200
+        int depth = 4;              // Maximum folder nesting level
+        int minSize = 256;          // Minimum uncompressed record size
+        int maxSize = 8192;         // Maximum uncompressed record size
+        int largePercent = 1;       // Percentage of large (track/dump) records
+        int largeSize = 1048576;    // Maximum size of large record
+        quint32 seed = 3000;        // Random generator seed
+    };
+
+    explicit DbGenerator(const Shape &shape);
+
+    bool generate(const QString &path);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+    // Record contents helpers, also useful for tests of the format itself
+    static QByteArray packData(const QByteArray &data, int level = -1); // -1 means zlib default level
+    static QByteArray makeProfile(const QList<QPair<QString, QVariant>> &items);
+
+private:
+    Shape m_shape;
+    QRandomGenerator m_random;
+    QString m_lastErrorMsg;
+
+    bool createDatabase(const QString &path);
+    bool fillDatabase(const QString &path);
+    QByteArray makeData(int size, int type);
+    QByteArray makeRecordProfile(int id, int size, const QDateTime &ctime);
+};
+
+#endif // DBGENERATOR_H
@@ -0,0 +1,72 @@
+QT       += core gui sql widgets concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = ace-database-bench
+
+# Viewer sources under test
+INCLUDEPATH += $$PWD/../src
+
+SOURCES += \
+    $$PWD/../src/CatalogCache/CatalogCache.cpp \
+    $$PWD/../src/Exporter/Exporter.cpp \
+    $$PWD/../src/FileWriter/FileWriter.cpp \
+    $$PWD/../src/FirebirdBackend/FirebirdBackend.cpp \
+    $$PWD/../src/InflateContext/InflateContext.cpp \
+    $$PWD/../src/InflateIndex/InflateIndex.cpp \
+    $$PWD/../src/Inflater/Inflater.cpp \
+    $$PWD/../src/OdsBackend/OdsBackend.cpp \
+    $$PWD/../src/OdsReader/OdsReader.cpp \
+    $$PWD/../src/PoolFileWriter/PoolFileWriter.cpp \
+    $$PWD/../src/ProfileItem/ProfileItem.cpp \
+    $$PWD/../src/RecordCache/RecordCache.cpp \
+    $$PWD/../src/RecordDevice/RecordDevice.cpp \
+    $$PWD/../src/SqlBackend/SqlBackend.cpp \
+    $$PWD/../src/SqlCore/SqlCore.cpp \
+    $$PWD/../src/SqliteBackend/SqliteBackend.cpp \
+    $$PWD/../src/Tracer/Tracer.cpp \
+    $$PWD/../src/TreeItem/TreeItem.cpp \
+    $$PWD/../src/TreeModel/TreeModel.cpp \
+    $$PWD/../src/ZlibInflater/ZlibInflater.cpp \
+    DbGenerator/DbGenerator.cpp \
+    main.cpp
+
+HEADERS += \
+    $$PWD/../src/CatalogCache/CatalogCache.h \
+    $$PWD/../src/Exporter/Exporter.h \
+    $$PWD/../src/FileWriter/FileWriter.h \
+    $$PWD/../src/FirebirdBackend/FirebirdBackend.h \
+    $$PWD/../src/InflateContext/InflateContext.h \
+    $$PWD/../src/InflateIndex/InflateIndex.h \
+    $$PWD/../src/Inflater/Inflater.h \
+    $$PWD/../src/OdsBackend/OdsBackend.h \
+    $$PWD/../src/OdsReader/OdsReader.h \
+    $$PWD/../src/PoolFileWriter/PoolFileWriter.h \
+    $$PWD/../src/ProfileItem/ProfileItem.h \
+    $$PWD/../src/RecordCache/RecordCache.h \
+    $$PWD/../src/RecordDevice/RecordDevice.h \
+    $$PWD/../src/SqlBackend/SqlBackend.h \
+    $$PWD/../src/SqlCore/SqlCore.h \
+    $$PWD/../src/SqliteBackend/SqliteBackend.h \
+    $$PWD/../src/StorageBackend/StorageBackend.h \
+    $$PWD/../src/Tracer/Tracer.h \
+    $$PWD/../src/TreeItem/TreeItem.h \
+    $$PWD/../src/TreeModel/TreeModel.h \
+    $$PWD/../src/ZlibInflater/ZlibInflater.h \
+    DbGenerator/DbGenerator.h
+
+# The same switch as for the viewer: qmake CONFIG+=libdeflate
+libdeflate {
+    DEFINES += USE_LIBDEFLATE
+    SOURCES += $$PWD/../src/LibdeflateInflater/LibdeflateInflater.cpp
+    HEADERS += $$PWD/../src/LibdeflateInflater/LibdeflateInflater.h
+    LIBS += -ldeflate
+}
+
+linux:liburing {
+    DEFINES += USE_LIBURING
+    SOURCES += $$PWD/../src/UringFileWriter/UringFileWriter.cpp
+    HEADERS += $$PWD/../src/UringFileWriter/UringFileWriter.h
+    LIBS += -luring
+}
@@ -0,0 +1,450 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QtEndian>
+#include "DbGenerator/DbGenerator.h"
+#include "SqlCore/SqlCore.h"
+#include "TreeModel/TreeModel.h"
+#include "ProfileItem/ProfileItem.h"
+#include "Exporter/Exporter.h"
+#include "FirebirdBackend/FirebirdBackend.h"
+#include "OdsBackend/OdsBackend.h"
+#include "Inflater/Inflater.h"
+#include "Tracer/Tracer.h"
+#include "RecordCache/RecordCache.h"
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+static QTextStream out(stdout);
+
+static void report(int records, const QString &phase, qint64 nsecs, qint64 items, qint64 bytes = 0)
+{
+    const double ms = nsecs / 1000000.0;
+    const double secs = nsecs / 1000000000.0;
+
+    QString rate;
+    if (secs > 0) {
+        rate = QString("%1 items/s").arg(items / secs, 0, 'f', 0);
+        if (bytes > 0)
+            rate += QString(", %1 MB/s").arg(bytes / secs / 1048576.0, 0, 'f', 1);
+    }
+
+    out << QString("%1 %2 %3 ms %4 items  %5")
+               .arg(records, 9)
+               .arg(phase, -12)
+               .arg(ms, 12, 'f', 2)
+               .arg(items, 9)
+               .arg(rate)
+        << Qt::endl;
+}
+
+// Evicts the file from OS page cache, so the next read goes to the disk.
+// Firebird server keeps its own page cache, it is not affected.
+static bool dropCache(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return posix_fadvise(file.handle(), 0, 0, POSIX_FADV_DONTNEED) == 0;
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+
+static void collectFiles(TreeItem *parent, QVector<TreeItem*> *files)
+{
+    for (int i = 0; i < parent->childCount(); i++) {
+        TreeItem *child = parent->childItem(i);
+        if (child->isFoler())
+            collectFiles(child, files);
+        else
+            files->append(child);
+    }
+}
+
+static qint64 walkModel(TreeModel *model, const QModelIndex &parent)
+{
+    qint64 count = 0;
+    const int rows = model->rowCount(parent);
+    const int columns = model->columnCount(parent);
+
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            QModelIndex index = model->index(row, column, parent);
+            model->data(index, Qt::DisplayRole);
+            model->parent(index);
+            count++;
+        }
+        count += walkModel(model, model->index(row, 0, parent));
+    }
+
+    return count;
+}
+
+static QVector<TreeItem*> sample(const QVector<TreeItem*> &files, int count)
+{
+    if (files.count() <= count)
+        return files;
+
+    // Evenly spaced sample keeps results comparable between runs
+    QVector<TreeItem*> result;
+    const double step = (double)files.count() / count;
+    for (int i = 0; i < count; i++)
+        result.append(files.at((int)(i * step)));
+    return result;
+}
+
+static int compareFolder(StorageBackend *expected, StorageBackend *actual, int folderId, qint64 *records)
+{
+    int errors = 0;
+
+    QVector<FolderRecord> expectedFolders = expected->folders(folderId);
+    QVector<FolderRecord> actualFolders = actual->folders(folderId);
+    auto folderLess = [](const FolderRecord &a, const FolderRecord &b) { return a.id < b.id; };
+    std::sort(expectedFolders.begin(), expectedFolders.end(), folderLess);
+    std::sort(actualFolders.begin(), actualFolders.end(), folderLess);
+
+    if (expectedFolders.count() != actualFolders.count()) {
+        out << "Folder " << folderId << ": " << actualFolders.count() << " subfolders, expected "
+            << expectedFolders.count() << Qt::endl;
+        return 1;
+    }
+
+    for (int i = 0; i < expectedFolders.count(); i++) {
+        const FolderRecord &e = expectedFolders.at(i);
+        const FolderRecord &a = actualFolders.at(i);
+        if ((e.id != a.id) || (e.parentId != a.parentId) || (e.name != a.name)) {
+            out << "Folder " << e.id << " mismatch" << Qt::endl;
+            errors++;
+        } else
+            errors += compareFolder(expected, actual, e.id, records);
+    }
+
+    QVector<FileRecord> expectedFiles = expected->files(folderId);
+    QVector<FileRecord> actualFiles = actual->files(folderId);
+    auto fileLess = [](const FileRecord &a, const FileRecord &b) { return a.id < b.id; };
+    std::sort(expectedFiles.begin(), expectedFiles.end(), fileLess);
+    std::sort(actualFiles.begin(), actualFiles.end(), fileLess);
+
+    if (expectedFiles.count() != actualFiles.count()) {
+        out << "Folder " << folderId << ": " << actualFiles.count() << " files, expected "
+            << expectedFiles.count() << Qt::endl;
+        return errors + 1;
+    }
+
+    for (int i = 0; i < expectedFiles.count(); i++) {
+        const FileRecord &e = expectedFiles.at(i);
+        const FileRecord &a = actualFiles.at(i);
+        if ((e.id != a.id) || (e.folderId != a.folderId) || (e.name != a.name) || (e.kind != a.kind)
+            || (e.size != a.size) || (e.ctime != a.ctime)) {
+            out << "File " << e.id << " mismatch" << Qt::endl;
+            errors++;
+            continue;
+        }
+
+        for (const char *blobName : { "DATA", "PROFILE" })
+            if (expected->blob(e.id, blobName) != actual->blob(a.id, blobName)) {
+                out << "File " << e.id << ": " << blobName << " BLOB mismatch" << Qt::endl;
+                errors++;
+            }
+
+        (*records)++;
+    }
+
+    return errors;
+}
+
+// Native reader must give exactly the same results as QIBASE driver
+static bool checkNativeReader(const QString &path)
+{
+    FirebirdBackend firebird;
+    OdsBackend native;
+    QElapsedTimer timer;
+
+    timer.start();
+    if (!firebird.open(path)) {
+        out << "Firebird error: " << firebird.lastErrorMsg() << Qt::endl;
+        return false;
+    }
+    out << "Firebird open: " << timer.elapsed() << " ms" << Qt::endl;
+
+    timer.start();
+    if (!native.open(path)) {
+        out << "Native reader error: " << native.lastErrorMsg() << Qt::endl;
+        return false;
+    }
+    out << "Native open: " << timer.elapsed() << " ms" << Qt::endl;
+
+    qint64 records = 0;
+    const int errors = compareFolder(&firebird, &native, 0, &records);
+    out << records << " records compared, " << errors << " mismatches" << Qt::endl;
+
+    return errors == 0;
+}
+
+static bool runBenchmark(const QDir &workDir, const DbGenerator::Shape &shape, int samples, bool regenerate,
+                         SqlCore::Engine engine, const QString &inflateEngine)
+{
+    const QString path = workDir.absoluteFilePath(QString("bench-%1.fdb").arg(shape.records));
+    QElapsedTimer timer;
+
+    if (regenerate || !QFile::exists(path)) {
+        DbGenerator generator(shape);
+        timer.start();
+        if (!generator.generate(path)) {
+            out << "Generator error: " << generator.lastErrorMsg() << Qt::endl;
+            return false;
+        }
+        report(shape.records, "generate", timer.nsecsElapsed(), shape.records);
+    }
+
+    SqlCore sqlCore;
+    sqlCore.setEngine(engine);
+    if (!inflateEngine.isEmpty())
+        sqlCore.setInflateEngine(inflateEngine);
+
+    // SqlCore::open
+    timer.start();
+    if (!sqlCore.open(path)) {
+        out << "Open error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return false;
+    }
+    report(shape.records, "open", timer.nsecsElapsed(), 1);
+
+    // SqlCore::enumerate, the same way MainWindow::open does it
+    TreeItem rootItem(-1, "ROOT", nullptr);
+    TreeItem *dbNameItem = new TreeItem(0, QFileInfo(path).completeBaseName(), &rootItem);
+    rootItem.append(dbNameItem);
+    timer.start();
+    sqlCore.enumerate(dbNameItem);
+    report(shape.records, "enumerate", timer.nsecsElapsed(), sqlCore.fileCount() + sqlCore.folderCount());
+
+    QVector<TreeItem*> files;
+    collectFiles(&rootItem, &files);
+    const QVector<TreeItem*> sampled = sample(files, samples);
+
+    // SqlCore::rawData
+    qint64 bytes = 0;
+    timer.start();
+    for (TreeItem *item : sampled)
+        bytes += sqlCore.rawData(item).size();
+    report(shape.records, "rawData", timer.nsecsElapsed(), sampled.count(), bytes);
+
+    // SqlCore::dataDevice, time to the first screen of the hex view
+    bytes = 0;
+    timer.start();
+    for (TreeItem *item : sampled) {
+        QScopedPointer<RecordDevice> device(sqlCore.dataDevice(item));
+        if (device && device->open(QIODevice::ReadOnly))
+            bytes += device->read(0x1000).size();
+    }
+    report(shape.records, "firstPage", timer.nsecsElapsed(), sampled.count(), bytes);
+
+    // Backward seeks inside large records, the first device builds inflate
+    // checkpoints and the second one reuses them. Shared page cache is off,
+    // otherwise the second pass would not inflate anything.
+    const qint64 cacheBudget = RecordCache::budget();
+    RecordCache::setBudget(0);
+    qint64 seeks = 0;
+    timer.start();
+    for (TreeItem *item : sampled) {
+        if (item->size() < InflateIndex::MIN_RECORD_SIZE)
+            continue;
+        for (int pass = 0; pass < 2; pass++) {
+            QScopedPointer<RecordDevice> device(sqlCore.dataDevice(item));
+            if (!device || !device->open(QIODevice::ReadOnly))
+                break;
+            for (int i = 15; i >= 0; i--) {
+                device->seek((item->size() - 1) * i / 15);
+                device->read(16);
+                seeks++;
+            }
+        }
+    }
+    if (seeks)
+        report(shape.records, "seek", timer.nsecsElapsed(), seeks);
+    RecordCache::setBudget(cacheBudget);
+
+    // Inflate engines on the same DATA BLOBs, results are checked byte for byte against zlib
+    QVector<QByteArray> blobs;
+    for (TreeItem *item : sampled)
+        blobs.append(sqlCore.backend()->blob(item->id(), "DATA"));
+    QMap<QString, QVector<QByteArray>> results;
+    for (const QString &name : Inflater::engines()) {
+        QScopedPointer<Inflater> inflater(Inflater::create(name));
+        QVector<QByteArray> &result = results[name];
+        bytes = 0;
+        timer.start();
+        for (const QByteArray &blob : qAsConst(blobs)) {
+            QByteArray buf;
+            if (blob.size() >= (int)sizeof(quint32)) {
+                buf.resize(qFromLittleEndian<quint32>(blob.constData()));
+                const qint64 written = inflater->inflate(blob.constData() + sizeof(quint32),
+                                                         blob.size() - sizeof(quint32),
+                                                         buf.data(),
+                                                         buf.size());
+                buf.truncate(qMax<qint64>(written, 0));
+            }
+            bytes += buf.size();
+            result.append(buf);
+        }
+        report(shape.records, "inflate:" + name, timer.nsecsElapsed(), blobs.count(), bytes);
+    }
+    for (const QString &name : results.keys())
+        if (results.value(name) != results.value("zlib"))
+            out << name << " results differ from zlib!" << Qt::endl;
+
+    // ProfileItem::fromRawData, profiles are fetched beforehand to measure parsing only
+    QVector<QByteArray> profiles;
+    for (TreeItem *item : sampled)
+        profiles.append(sqlCore.rawProfile(item));
+    qint64 parameters = 0;
+    timer.start();
+    for (const QByteArray &profile : profiles)
+        parameters += ProfileItem::fromRawData(profile).count();
+    report(shape.records, "profile", timer.nsecsElapsed(), parameters);
+
+    // TreeModel navigation over the whole tree
+    TreeModel model;
+    model.setRootItem(&rootItem);
+    timer.start();
+    qint64 cells = walkModel(&model, QModelIndex());
+    report(shape.records, "navigation", timer.nsecsElapsed(), cells);
+    model.setRootItem(nullptr);
+
+    // Export All with every writer: QFile as before, thread pool and io_uring
+    QStringList writers;
+    for (FileWriter::Kind kind : { FileWriter::SyncWriter, FileWriter::PoolWriter, FileWriter::UringWriter }) {
+        const QString name = QScopedPointer<FileWriter>(FileWriter::create(kind))->name();
+        if (writers.contains(name))
+            continue; // Fallback to the writer measured already
+        writers.append(name);
+
+        QDir exportDir(workDir.absoluteFilePath(QString("export-%1").arg(shape.records)));
+        exportDir.removeRecursively();
+        workDir.mkpath(exportDir.absolutePath());
+        Exporter exporter(&sqlCore, kind);
+        timer.start();
+        bool ok = exporter.exportItems(exportDir, &rootItem);
+        report(shape.records, "export:" + name, timer.nsecsElapsed(), files.count(), sqlCore.totalSize());
+        exportDir.removeRecursively();
+        if (!ok)
+            out << "Export completed with errors!" << Qt::endl;
+    }
+
+    // Tree order against storage order with cold cache. The connection is
+    // reopened for every run, database file is evicted from page cache
+    // while nothing maps it.
+    const qint64 totalSize = sqlCore.totalSize();
+    for (Exporter::Order order : { Exporter::TreeOrder, Exporter::StorageOrder }) {
+        const QString name = (order == Exporter::TreeOrder) ? "tree" : "storage";
+        sqlCore.openLater(path);
+        const bool cold = dropCache(path);
+        if (!sqlCore.openPending()) {
+            out << "Open error: " << sqlCore.lastErrorMsg() << Qt::endl;
+            return false;
+        }
+
+        QDir exportDir(workDir.absoluteFilePath(QString("export-%1").arg(shape.records)));
+        exportDir.removeRecursively();
+        workDir.mkpath(exportDir.absolutePath());
+        Exporter exporter(&sqlCore);
+        exporter.setOrder(order);
+        timer.start();
+        bool ok = exporter.exportItems(exportDir, &rootItem);
+        report(shape.records, (cold ? "cold:" : "warm:") + name, timer.nsecsElapsed(), files.count(), totalSize);
+        exportDir.removeRecursively();
+        if (!ok)
+            out << "Export completed with errors!" << Qt::endl;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // Tree model needs GUI application, but no display is required
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    app.setApplicationName("ace-database-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ace Database Viewer benchmark suite");
+    parser.addHelpOption();
+    parser.addOption({ "records", "Comma separated database sizes.", "list", "1000,100000,1000000" });
+    parser.addOption({ "workdir", "Directory for generated databases.", "path",
+                       QDir::temp().absoluteFilePath("ace-bench") });
+    parser.addOption({ "samples", "Number of records for rawData & profile tests.", "count", "1000" });
+    parser.addOption({ "min-size", "Minimum record size.", "bytes", "256" });
+    parser.addOption({ "max-size", "Maximum record size.", "bytes", "8192" });
+    parser.addOption({ "large-percent", "Percentage of large records.", "percent", "1" });
+    parser.addOption({ "large-size", "Maximum size of large record.", "bytes", "1048576" });
+    parser.addOption({ "regenerate", "Regenerate databases even if they exist." });
+    parser.addOption({ "engine", "Database engine: auto, firebird or native.", "name", "auto" });
+    parser.addOption({ "inflate", "Decompression engine of rawData tests: " + Inflater::engines().join(", ") + ".", "name" });
+    parser.addOption({ "check", "Compare native reader with QIBASE driver on <database>.", "database" });
+    parser.addOption({ "trace", "Write Chrome trace JSON of all runs to <file>.", "file" });
+    parser.process(app);
+
+    if (parser.isSet("check"))
+        return checkNativeReader(parser.value("check")) ? 0 : 1;
+
+    if (parser.isSet("inflate") && !Inflater::engines().contains(parser.value("inflate"))) {
+        out << "Unknown decompression engine " << parser.value("inflate") << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet("trace"))
+        Tracer::start(parser.value("trace"));
+
+    QDir workDir(parser.value("workdir"));
+    if (!workDir.mkpath(".")) {
+        out << "Can't create work directory " << workDir.absolutePath() << Qt::endl;
+        return 1;
+    }
+
+    out << QString("%1 %2 %3    %4        %5")
+               .arg("records", 9)
+               .arg("phase", -12)
+               .arg("time", 12)
+               .arg("items", 9)
+               .arg("rate")
+        << Qt::endl;
+
+    const QStringList sizes = parser.value("records").split(',', Qt::SkipEmptyParts);
+    for (const QString &size : sizes) {
+        DbGenerator::Shape shape;
+        shape.records = size.toInt();
+        shape.minSize = parser.value("min-size").toInt();
+        shape.maxSize = parser.value("max-size").toInt();
+        shape.largePercent = parser.value("large-percent").toInt();
+        shape.largeSize = parser.value("large-size").toInt();
+
+        if (!runBenchmark(workDir, shape, parser.value("samples").toInt(), parser.isSet("regenerate"),
+                          SqlCore::engineFromString(parser.value("engine")), parser.value("inflate")))
+            return 1;
+    }
+
+    if (Tracer::isEnabled()) {
+        QString errorMsg;
+        out << Qt::endl << Tracer::finish(&errorMsg) << Qt::flush;
+        if (!errorMsg.isEmpty()) {
+            out << "Error: " << errorMsg << Qt::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
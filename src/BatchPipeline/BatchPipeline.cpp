@@ -0,0 +1,22 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "BatchPipeline.h"
+
+void BatchPipeline::collectFiles(TreeItem *parentItem, const QString &prefix, QVector<QPair<TreeItem*, QString>> *files)
+{
+    for (int i = 0; i < parentItem->childCount(); i++) {
+        TreeItem *item = parentItem->childItem(i);
+        const QString path = prefix + item->name();
+
+        if (item->isFoler())
+            collectFiles(item, path + "/", files);
+        else
+            files->append({ item, path });
+    }
+}
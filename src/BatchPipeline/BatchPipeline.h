@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef BATCHPIPELINE_H
+#define BATCHPIPELINE_H
+
+#include <QtConcurrent>
+#include "TreeItem/TreeItem.h"
+
+// Whole-database passes (verify, catalog, diff, repack) read BLOBs on the
+// calling thread, the database connection belongs to it, and process them
+// on the thread pool. The next batch is read while the previous one is
+// processed, batches are handed back in order.
+class BatchPipeline
+{
+public:
+    static const qint64 BATCH_BYTES = 64 * 1024 * 1024;
+    static const int BATCH_COUNT = 1024;
+
+    // Files under the parent item in tree order with paths relative to it
+    static void collectFiles(TreeItem *parentItem, const QString &prefix, QVector<QPair<TreeItem*, QString>> *files);
+
+    // Runs jobs 0..count-1: fetch(index, job) fills a job on this thread and
+    // returns bytes it holds, work(job) runs on the thread pool, done(batch,
+    // first) gets processed batches with index of the first job on this
+    // thread. Returns false as soon as done() does.
+    template <typename Job, typename Fetch, typename Done>
+    static bool run(int count, Fetch fetch, void (*work)(Job &), Done done,
+                    int batchCount = BATCH_COUNT, qint64 batchBytes = BATCH_BYTES);
+};
+
+template <typename Job, typename Fetch, typename Done>
+bool BatchPipeline::run(int count, Fetch fetch, void (*work)(Job &), Done done, int batchCount, qint64 batchBytes)
+{
+    QVector<Job> running, next;
+    QFuture<void> future;
+    int index = 0, runningIndex = 0;
+
+    while ((index < count) || !running.isEmpty()) {
+        next.clear();
+        const int nextIndex = index;
+        qint64 bytes = 0;
+        while ((index < count) && (bytes < batchBytes) && (next.count() < batchCount)) {
+            Job job;
+            bytes += fetch(index, job);
+            next.append(job);
+            index++;
+        }
+
+        future.waitForFinished();
+
+        if (!running.isEmpty() && !done(running, runningIndex))
+            return false;
+
+        running.swap(next);
+        runningIndex = nextIndex;
+        if (!running.isEmpty())
+            future = QtConcurrent::map(running, work);
+    }
+
+    return true;
+}
+
+#endif // BATCHPIPELINE_H
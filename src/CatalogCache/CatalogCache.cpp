@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "CatalogCache.h"
+
+static const char magic[8] = { 'A', 'C', 'E', 'C', 'A', 'T', '0', '2' };
+
+// Invalid creation time marker
+static const qint64 noTime = std::numeric_limits<qint64>::min();
+
+static void collectItems(TreeItem *parentItem, int parentIndex,
+                         QVector<catalog_item_t> *items, QString *names)
+{
+    for (int i = 0; i < parentItem->childCount(); i++) {
+        TreeItem *child = parentItem->childItem(i);
+        const QString name = child->name();
+        const QDateTime ctime = child->ctime();
+
+        catalog_item_t item;
+        item.parentIndex = parentIndex;
+        item.id = child->id();
+        item.size = child->isFoler() ? 0 : child->size();
+        item.type = child->isFoler() ? 0 : child->type();
+        item.folder = child->isFoler() ? 1 : 0;
+        item.flags = child->hasMoreFiles() ? CATALOG_MORE_FILES : 0;
+        item.ctime = ctime.isValid() ? ctime.toMSecsSinceEpoch() : noTime;
+        item.nameOffset = names->size();
+        item.nameLength = name.size();
+
+        names->append(name);
+        items->append(item);
+
+        // Parent is always written before its children
+        if (child->isFoler())
+            collectItems(child, items->count() - 1, items, names);
+    }
+}
+
+bool CatalogCache::load(const QString &dbPath, TreeItem *parentItem)
+{
+    const QFileInfo info(dbPath);
+    QFile f(cachePath(dbPath));
+
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 fileSize = f.size();
+    if (fileSize < (qint64)sizeof(catalog_header_t))
+        return false;
+
+    const uchar *data = f.map(0, fileSize);
+    if (!data)
+        return false;
+
+    const catalog_header_t *header = (const catalog_header_t *)data;
+    if ((memcmp(header->magic, magic, sizeof(magic)) != 0)
+        || (header->dbSize != info.size())
+        || (header->dbModified != info.lastModified().toMSecsSinceEpoch()))
+        return false;
+
+    const qint64 expectedSize = sizeof(catalog_header_t)
+                                + (qint64)header->itemCount * sizeof(catalog_item_t)
+                                + (qint64)header->nameLength * sizeof(QChar);
+    if (fileSize != expectedSize)
+        return false;
+
+    const catalog_item_t *items = (const catalog_item_t *)(data + sizeof(catalog_header_t));
+    const QChar *names = (const QChar *)(items + header->itemCount);
+
+    QVector<TreeItem*> treeItems(header->itemCount, nullptr);
+
+    for (quint32 i = 0; i < header->itemCount; i++) {
+        const catalog_item_t &item = items[i];
+
+        if ((item.parentIndex >= (qint32)i)
+            || ((quint64)item.nameOffset + item.nameLength > header->nameLength)) {
+            // Broken cache file: drop everything loaded so far
+            parentItem->clear();
+            return false;
+        }
+
+        TreeItem *parent = (item.parentIndex < 0) ? parentItem : treeItems.at(item.parentIndex);
+        const QString name(names + item.nameOffset, item.nameLength);
+
+        TreeItem *child;
+        if (item.folder)
+            child = new TreeItem(item.id, name, parent);
+        else
+            child = new TreeItem(item.id,
+                                 item.size,
+                                 (TreeItem::DataType)item.type,
+                                 name,
+                                 item.ctime == noTime ? QDateTime() : QDateTime::fromMSecsSinceEpoch(item.ctime),
+                                 parent);
+
+        parent->append(child);
+        if (item.flags & CATALOG_MORE_FILES)
+            child->setMoreFiles(true);
+        treeItems[i] = child;
+    }
+
+    if (header->flags & CATALOG_MORE_FILES)
+        parentItem->setMoreFiles(true);
+
+    return true;
+}
+
+bool CatalogCache::save(const QString &dbPath, TreeItem *parentItem)
+{
+    const QFileInfo info(dbPath);
+    const QString path = cachePath(dbPath);
+
+    QVector<catalog_item_t> items;
+    QString names;
+    collectItems(parentItem, -1, &items, &names);
+
+    catalog_header_t header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.dbSize = info.size();
+    header.dbModified = info.lastModified().toMSecsSinceEpoch();
+    header.itemCount = items.count();
+    header.nameLength = names.size();
+    header.flags = parentItem->hasMoreFiles() ? CATALOG_MORE_FILES : 0;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+
+    f.write((const char *)&header, sizeof(header));
+    f.write((const char *)items.constData(), items.count() * sizeof(catalog_item_t));
+    f.write((const char *)names.constData(), names.size() * sizeof(QChar));
+
+    return f.commit();
+}
+
+QString CatalogCache::cachePath(const QString &dbPath)
+{
+    const QString location = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const QByteArray key = QCryptographicHash::hash(QFileInfo(dbPath).absoluteFilePath().toUtf8(),
+                                                    QCryptographicHash::Sha1).toHex();
+
+    return location + "/catalog/" + key + ".cat";
+}
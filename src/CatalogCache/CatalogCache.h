@@ -0,0 +1,62 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef CATALOGCACHE_H
+#define CATALOGCACHE_H
+
+#include <QtCore>
+#include "TreeItem/TreeItem.h"
+
+// Binary sidecar cache of the database catalog (folder & file tree),
+// keyed by database file path, size and modification time
+class CatalogCache
+{
+public:
+    // Loads cached catalog as children of the parent item, returns false
+    // if there is no cache for the database or the cache is out of date
+    static bool load(const QString &dbPath, TreeItem *parentItem);
+    // Saves children of the parent item as catalog of the database
+    static bool save(const QString &dbPath, TreeItem *parentItem);
+
+private:
+    static QString cachePath(const QString &dbPath);
+};
+
+/*************************************************/
+/********* Cache file structures BEGIN ***********/
+/*************************************************/
+
+typedef struct __attribute__ ((packed)) {
+    char magic[8];          // "ACECAT02"
+    qint64 dbSize;          // Database file size
+    qint64 dbModified;      // Database file modification time, ms since epoch
+    quint32 itemCount;      // Number of catalog_item_t entries
+    quint32 nameLength;     // Total length of names, in UTF-16 units
+    quint32 flags;          // Flags of the top level folder, CATALOG_MORE_FILES
+} catalog_header_t;
+
+// Folder files are loaded partially, see SqlCore::setPageSize()
+#define CATALOG_MORE_FILES 0x0001
+
+typedef struct __attribute__ ((packed)) {
+    qint32 parentIndex;     // Index of parent entry, -1 for top level items
+    qint32 id;              // Source database record ID
+    qint32 size;            // File size in bytes
+    quint8 type;            // TreeItem::DataType
+    quint8 folder;          // 1 for folder, 0 for file
+    quint16 flags;          // CATALOG_MORE_FILES
+    qint64 ctime;           // Creation time, ms since epoch
+    quint32 nameOffset;     // Offset in names area, in UTF-16 units
+    quint32 nameLength;     // Name length, in UTF-16 units
+} catalog_item_t;
+
+/*************************************************/
+/********** Cache file structures END ************/
+/*************************************************/
+
+#endif // CATALOGCACHE_H
@@ -0,0 +1,204 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "CatalogWriter.h"
+#include "ProfileItem/ProfileItem.h"
+#include "Tracer/Tracer.h"
+#include "BatchPipeline/BatchPipeline.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// Profiles are small, a batch has more of them than BatchPipeline's default
+static const int BATCH_COUNT = 4096;
+
+// Largest integer a double holds exactly
+static const qint64 MAX_SAFE_INTEGER = Q_INT64_C(1) << 53;
+
+struct CatalogJob {
+    CatalogWriter::Format format;
+    TreeItem *item;
+    QString path;
+    QByteArray profile;
+    QByteArray text;
+};
+
+static QByteArray csvField(const QString &value)
+{
+    QByteArray field = value.toUtf8();
+
+    if (field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r'))
+        field = '"' + field.replace("\"", "\"\"") + '"';
+
+    return field;
+}
+
+static QJsonValue jsonValue(const QVariant &value)
+{
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::Double:
+        return value.toDouble();
+    // JSON numbers are doubles, integers above 2^53 are written as strings
+    case QVariant::LongLong: {
+        const qint64 number = value.toLongLong();
+        if ((number >= -MAX_SAFE_INTEGER) && (number <= MAX_SAFE_INTEGER))
+            return number;
+        return QString::number(number);
+    }
+    case QVariant::ULongLong: {
+        const quint64 number = value.toULongLong();
+        if (number <= (quint64)MAX_SAFE_INTEGER)
+            return (qint64)number;
+        return QString::number(number);
+    }
+    case QVariant::Bool:
+        return value.toBool();
+    case QVariant::Date:
+        return value.toDate().toString(Qt::ISODate);
+    case QVariant::DateTime:
+        return value.toDateTime().toString(Qt::ISODate);
+    default:
+        return value.toString();
+    }
+}
+
+static void formatCsv(CatalogJob &job, const QVector<ProfileItem> &items)
+{
+    const QByteArray file = csvField(job.path) + ','
+                            + QByteArray::number(job.item->id()) + ','
+                            + QByteArray::number(job.item->size()) + ','
+                            + csvField(TreeItem::DataTypeToText(job.item->type())) + ','
+                            + csvField(job.item->ctime().toString(Qt::ISODate)) + ',';
+
+    if (items.isEmpty())
+        job.text = file + ",\n";
+
+    for (const ProfileItem &item : items) {
+        const QVariant &value = item.value;
+        // Dates are written the same way in both formats
+        const QString text = ((value.type() == QVariant::Date) || (value.type() == QVariant::DateTime))
+                                 ? jsonValue(value).toString()
+                                 : value.toString();
+        job.text += file + csvField(item.parameter.toUpper()) + ',' + csvField(text) + '\n';
+    }
+}
+
+static void formatJson(CatalogJob &job, const QVector<ProfileItem> &items)
+{
+    QJsonObject profile;
+    for (const ProfileItem &item : items)
+        profile.insert(item.parameter.toUpper(), jsonValue(item.value));
+
+    QJsonObject object;
+    object.insert("path", job.path);
+    object.insert("id", job.item->id());
+    object.insert("size", job.item->size());
+    object.insert("type", TreeItem::DataTypeToText(job.item->type()));
+    object.insert("created", job.item->ctime().isValid() ? QJsonValue(job.item->ctime().toString(Qt::ISODate))
+                                                         : QJsonValue());
+    object.insert("profile", profile);
+
+    job.text = QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+static void formatJob(CatalogJob &job)
+{
+    const QVector<ProfileItem> items = ProfileItem::fromRawData(job.profile);
+
+    if (job.format == CatalogWriter::Csv)
+        formatCsv(job, items);
+    else
+        formatJson(job, items);
+
+    // Don't keep BLOBs until the batch is written
+    job.profile.clear();
+}
+
+CatalogWriter::CatalogWriter(SqlCore *sqlCore, QObject *parent)
+    : QObject{parent},
+    m_sqlCore(sqlCore),
+    m_writtenCount(0),
+    m_canceled(false)
+{
+
+}
+
+bool CatalogWriter::write(QIODevice *device, TreeItem *parentItem, Format format)
+{
+    TRACE_SCOPE("catalog write");
+
+    m_writtenCount = 0;
+    m_canceled = false;
+    m_lastErrorMsg.clear();
+
+    QVector<QPair<TreeItem*, QString>> files;
+    BatchPipeline::collectFiles(parentItem, QString(), &files);
+
+    if (format == Csv) {
+        const QByteArray header = "path,id,size,type,created,parameter,value\n";
+        if (device->write(header) != header.size()) {
+            m_lastErrorMsg = "Output writing error!";
+            return false;
+        }
+    }
+
+    if (files.isEmpty())
+        return true;
+
+    StorageBackend *backend = m_sqlCore->backend();
+    if (!backend) {
+        m_lastErrorMsg = m_sqlCore->lastErrorMsg();
+        return false;
+    }
+
+    auto fetch = [&](int index, CatalogJob &job) {
+        job.format = format;
+        job.item = files.at(index).first;
+        job.path = files.at(index).second;
+        job.profile = backend->blob(job.item->id(), "PROFILE");
+        return (qint64)job.profile.size();
+    };
+
+    // Batch order is the tree order
+    auto done = [&](const QVector<CatalogJob> &batch, int) {
+        for (const CatalogJob &job : batch)
+            if (device->write(job.text) != job.text.size()) {
+                m_lastErrorMsg = "Output writing error!";
+                return false;
+            }
+
+        m_writtenCount += batch.count();
+        emit progress(m_writtenCount, files.count());
+
+        if (m_canceled) {
+            m_lastErrorMsg = "Canceled by user.";
+            return false;
+        }
+
+        return true;
+    };
+
+    return BatchPipeline::run(files.count(), fetch, formatJob, done, BATCH_COUNT);
+}
+    return true;
+}
+
+bool CatalogWriter::formatFromString(const QString &name, Format *format)
+{
+    const QString suffix = name.section('.', -1).toLower();
+
+    if (suffix == "csv")
+        *format = Csv;
+    else if ((suffix == "jsonl") || (suffix == "json"))
+        *format = JsonLines;
+    else
+        return false;
+
+    return true;
+}
@@ -0,0 +1,53 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef CATALOGWRITER_H
+#define CATALOGWRITER_H
+
+#include <QObject>
+#include "SqlCore/SqlCore.h"
+#include "TreeItem/TreeItem.h"
+
+// Streams file list with parsed profiles as CSV or JSON Lines. Profiles
+// are fetched on the calling thread batch by batch, parsed and formatted
+// on the thread pool while the next batch is fetched; batches are written
+// in tree order, so the output doesn't depend on thread timing.
+class CatalogWriter : public QObject
+{
+    Q_OBJECT
+public:
+    // CSV has a row per profile parameter (path, id, size, type, created,
+    // parameter, value), a file without profile has one row with empty
+    // parameter. JSON Lines has an object per file with "profile" object.
+    enum Format { Csv, JsonLines };
+
+    explicit CatalogWriter(SqlCore *sqlCore, QObject *parent = nullptr);
+
+    // Writes all files under the parent item, returns false on database
+    // or output error
+    bool write(QIODevice *device, TreeItem *parentItem, Format format);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+    int writtenCount() const { return m_writtenCount; }
+
+    // "csv" or "jsonl", file name extension is used too
+    static bool formatFromString(const QString &name, Format *format);
+
+signals:
+    void progress(int done, int total);
+
+public slots:
+    void cancel() { m_canceled = true; }
+
+private:
+    SqlCore *m_sqlCore;
+    int m_writtenCount;
+    bool m_canceled;
+    QString m_lastErrorMsg;
+};
+
+#endif // CATALOGWRITER_H
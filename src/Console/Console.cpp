@@ -0,0 +1,577 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Console.h"
+#include <QFileInfo>
+#include "SqliteConverter/SqliteConverter.h"
+#include "DbDiff/DbDiff.h"
+#include "Verifier/Verifier.h"
+#include "Tracer/Tracer.h"
+#include "Exporter/Exporter.h"
+#include "RecordDiff/RecordDiff.h"
+#include "CatalogWriter/CatalogWriter.h"
+#include "Repacker/Repacker.h"
+#ifdef USE_FUSE
+#include "FuseMount/FuseMount.h"
+#endif
+
+static const char *commands[] = { "convert", "diff", "verify", "export", "mount", "record-diff", "catalog", "repack" };
+
+static QTextStream out(stdout);
+static QTextStream err(stderr);
+
+bool Console::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+        for (const char *command : commands) {
+            const QByteArray arg(argv[i]);
+            const QByteArray option = QByteArray("--") + command;
+            if ((arg == option) || arg.startsWith(option + "="))
+                return true;
+        }
+
+    return false;
+}
+
+int Console::exec(QCoreApplication &app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ACE Lab (R) PC-3000 database viewer & extractor");
+    parser.addHelpOption();
+    parser.addOption({ "convert", "Convert database into indexed SQLite <file>.", "file" });
+    parser.addOption({ "diff", "Compare database with newer <file>. Exit code is 0 if databases "
+                               "are equal, 1 if they differ, 2 on error.", "file" });
+    parser.addOption({ "content", "Compare content of all files, not only of files with changed time." });
+    parser.addOption({ "verify", "Check integrity of all files. Exit code is 0 if no problems found, "
+                                 "1 if there are corrupt files, 2 on error." });
+    parser.addOption({ "export", "Export files into <dir>. Only files matching all filter options below "
+                                 "are fetched from the database.", "dir" });
+    parser.addOption({ "kind", "Filter: comma separated data types, numbers or names "
+                               "(rawdata, firmware, romdump, ramdump, adaptives, track, plaintext, internaldata).", "list" });
+    parser.addOption({ "from", "Filter: created at or after <time>, yyyy-MM-dd or yyyy-MM-ddThh:mm:ss.", "time" });
+    parser.addOption({ "to", "Filter: created at or before <time>, yyyy-MM-dd or yyyy-MM-ddThh:mm:ss.", "time" });
+    parser.addOption({ "min-size", "Filter: size at least <bytes>.", "bytes" });
+    parser.addOption({ "max-size", "Filter: size at most <bytes>.", "bytes" });
+    parser.addOption({ "name", "Filter: file name wildcard pattern, case insensitive.", "pattern" });
+    parser.addOption({ "folder", "Filter: export only folder <path> (like \"Family/Model\") and its subfolders. "
+                                 "Repack: folder or file <path> (or #ID) to write, may be repeated.", "path" });
+    parser.addOption({ "catalog", "Write list of files with profile parameters to <file> (- for standard output) "
+                                  "as CSV, a row per parameter, or JSON Lines, an object per file.", "file" });
+    parser.addOption({ "format", "Catalog format: csv or jsonl, by file extension if not set.", "name" });
+    parser.addOption({ "repack", "Write folders given by --folder (whole database if not set) into new database "
+                                 "<file>, *.pcr/*.fdb (needs Firebird isql tool) or *.sqlite. "
+                                 "DATA BLOBs are recompressed.", "file" });
+    parser.addOption({ "level", "Repack: zlib compression level 0..9.", "level",
+                       QString::number(Repacker::DEFAULT_LEVEL) });
+    parser.addOption({ "no-sparse", "Export: write zero runs instead of leaving holes in files." });
+    parser.addOption({ "mount", "Mount database as read-only filesystem at <dir> until it is unmounted "
+                                "or interrupted with Ctrl+C. Files are decompressed on read.", "dir" });
+    parser.addOption({ "record-diff", "Compare file <path> (like \"Family/Model/File\", or #ID) byte by byte "
+                                      "with file given by --record-with and print differing ranges. "
+                                      "Exit code is 0 if files are equal, 1 if they differ, 2 on error.", "path" });
+    parser.addOption({ "record-with", "Second file for --record-diff.", "path" });
+    parser.addOption({ "record-db", "Database of the second file for --record-diff, the same one by default.", "file" });
+    parser.addOption({ "user", "Firebird user name.", "name" });
+    parser.addOption({ "password", "Firebird password.", "password" });
+    parser.addOption({ "engine", "Database engine: auto, firebird or native.", "name", "auto" });
+    parser.addOption({ "inflate", "Decompression engine: " + Inflater::engines().join(", ") + ".", "name" });
+    parser.addOption({ "trace", "Write Chrome trace JSON to <file> and print time per phase.", "file" });
+    parser.addPositionalArgument("database", "Database file (*.pcr, *.fdb or SQLite mirror).");
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.count() != 1) {
+        err << "Exactly one database file expected." << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet("trace"))
+        Tracer::start(parser.value("trace"));
+
+    int result = 0;
+
+    if (parser.isSet("convert"))
+        result = convert(parser, args.first());
+    else if (parser.isSet("diff"))
+        result = diff(parser, args.first());
+    else if (parser.isSet("verify"))
+        result = verify(parser, args.first());
+    else if (parser.isSet("export"))
+        result = exportFiles(parser, args.first());
+    else if (parser.isSet("mount"))
+        result = mount(parser, args.first());
+    else if (parser.isSet("record-diff"))
+        result = recordDiff(parser, args.first());
+    else if (parser.isSet("catalog"))
+        result = catalog(parser, args.first());
+    else if (parser.isSet("repack"))
+        result = repack(parser, args.first());
+
+    if (Tracer::isEnabled()) {
+        QString errorMsg;
+        err << Tracer::finish(&errorMsg) << Qt::flush;
+        if (!errorMsg.isEmpty())
+            err << "Error: " << errorMsg << Qt::endl;
+    }
+
+    return result;
+}
+
+void Console::setup(const QCommandLineParser &parser, SqlCore *sqlCore)
+{
+    if (parser.isSet("user"))
+        sqlCore->setCredentials(parser.value("user"), parser.value("password"));
+    sqlCore->setEngine(SqlCore::engineFromString(parser.value("engine")));
+    if (parser.isSet("inflate") && !sqlCore->setInflateEngine(parser.value("inflate")))
+        err << "Unknown decompression engine, " << sqlCore->inflateEngine() << " is used." << Qt::endl;
+}
+
+int Console::convert(const QCommandLineParser &parser, const QString &path)
+{
+    SqlCore sqlCore;
+    setup(parser, &sqlCore);
+
+    if (!sqlCore.open(path)) {
+        err << "Error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    SqliteConverter converter(sqlCore.backend());
+    QObject::connect(&converter, &SqliteConverter::progress, [](int count) {
+        if (count % 1000 == 0)
+            out << "\r" << count << " records converted" << Qt::flush;
+    });
+
+    if (!converter.convert(parser.value("convert"))) {
+        err << Qt::endl << "Error: " << converter.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    out << Qt::endl << "Completed successfully." << Qt::endl;
+    return 0;
+}
+
+int Console::diff(const QCommandLineParser &parser, const QString &path)
+{
+    SqlCore oldCore, newCore;
+    setup(parser, &oldCore);
+    setup(parser, &newCore);
+
+    TreeItem oldRoot(0, "OLD", nullptr);
+    TreeItem newRoot(0, "NEW", nullptr);
+
+    if (!oldCore.load(path, &oldRoot)) {
+        err << "Error: " << oldCore.lastErrorMsg() << Qt::endl;
+        return 2;
+    }
+
+    if (!newCore.load(parser.value("diff"), &newRoot)) {
+        err << "Error: " << newCore.lastErrorMsg() << Qt::endl;
+        return 2;
+    }
+
+    DbDiff dbDiff(&oldCore, &newCore);
+    QObject::connect(&dbDiff, &DbDiff::progress, [](int done, int total) {
+        err << "\r" << done << " of " << total << " files compared by content" << Qt::flush;
+    });
+
+    const bool ok = dbDiff.compare(&oldRoot, &newRoot, parser.isSet("content"));
+    if (dbDiff.hashedCount())
+        err << Qt::endl;
+
+    if (!ok) {
+        err << "Error: " << dbDiff.lastErrorMsg() << Qt::endl;
+        return 2;
+    }
+
+    for (const DbDiff::Entry &entry : dbDiff.entries()) {
+        switch (entry.change) {
+        case DbDiff::Added:
+            out << "+ " << entry.path << Qt::endl;
+            break;
+        case DbDiff::Removed:
+            out << "- " << entry.path << Qt::endl;
+            break;
+        case DbDiff::Changed:
+            out << "* " << entry.path << " (" << entry.reason << ", "
+                << entry.oldItem->size() << " -> " << entry.newItem->size() << " bytes)" << Qt::endl;
+            break;
+        }
+    }
+
+    out << dbDiff.count(DbDiff::Added) << " added, "
+        << dbDiff.count(DbDiff::Removed) << " removed, "
+        << dbDiff.count(DbDiff::Changed) << " changed, "
+        << dbDiff.unchangedCount() << " unchanged." << Qt::endl;
+
+    return dbDiff.entries().isEmpty() ? 0 : 1;
+}
+
+int Console::verify(const QCommandLineParser &parser, const QString &path)
+{
+    SqlCore sqlCore;
+    setup(parser, &sqlCore);
+
+    TreeItem root(0, "ROOT", nullptr);
+
+    if (!sqlCore.load(path, &root)) {
+        err << "Error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return 2;
+    }
+
+    Verifier verifier(&sqlCore);
+    QObject::connect(&verifier, &Verifier::progress, [](int done, int total) {
+        err << "\r" << done << " of " << total << " files verified" << Qt::flush;
+    });
+
+    const bool ok = verifier.verify(&root);
+    err << Qt::endl;
+
+    if (!ok) {
+        err << "Error: " << verifier.lastErrorMsg() << Qt::endl;
+        return 2;
+    }
+
+    for (const Verifier::Problem &problem : verifier.problems())
+        out << problem.path << ": " << problem.message << Qt::endl;
+
+    out << verifier.checkedCount() << " files verified, "
+        << verifier.problems().count() << " corrupt." << Qt::endl;
+
+    return verifier.problems().isEmpty() ? 0 : 1;
+}
+
+int Console::exportFiles(const QCommandLineParser &parser, const QString &path)
+{
+    FileFilter filter;
+    if (!parseFilter(parser, &filter))
+        return 1;
+
+    SqlCore sqlCore;
+    setup(parser, &sqlCore);
+
+    TreeItem root(0, "ROOT", nullptr);
+
+    if (!sqlCore.load(path, &root)) {
+        err << "Error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    // Subtree to export
+    TreeItem *parent = findItem(&root, parser.value("folder"));
+    if (!parent || !parent->isFoler()) {
+        err << "Error: folder " << parser.value("folder") << " not found." << Qt::endl;
+        return 1;
+    }
+
+    QDir dir(parser.value("export"));
+    if (!dir.mkpath(".")) {
+        err << "Error: can't create " << dir.absolutePath() << Qt::endl;
+        return 1;
+    }
+
+    Exporter exporter(&sqlCore);
+    exporter.setSparse(!parser.isSet("no-sparse"));
+    const bool ok = exporter.exportFiltered(dir, parent, filter);
+
+    out << exporter.exportedCount() << " files exported." << Qt::endl;
+    if (exporter.fillStats().bytes)
+        out << "Padding: " << Exporter::fillToText(exporter.fillStats()) << Qt::endl;
+
+    if (!ok) {
+        err << "Error: " << exporter.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Console::catalog(const QCommandLineParser &parser, const QString &path)
+{
+    const QString fileName = parser.value("catalog");
+    const bool toStdout = (fileName == "-");
+
+    CatalogWriter::Format format = CatalogWriter::JsonLines;
+    if (!CatalogWriter::formatFromString(parser.isSet("format") ? "." + parser.value("format") : fileName, &format)
+        && (parser.isSet("format") || !toStdout)) {
+        err << "Error: unknown catalog format, use --format csv or jsonl." << Qt::endl;
+        return 1;
+    }
+
+    SqlCore sqlCore;
+    setup(parser, &sqlCore);
+
+    TreeItem root(0, "ROOT", nullptr);
+
+    if (!sqlCore.load(path, &root)) {
+        err << "Error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    QFile file(fileName);
+    const bool opened = toStdout ? file.open(stdout, QIODevice::WriteOnly) : file.open(QIODevice::WriteOnly);
+    if (!opened) {
+        err << "Error: can't create " << fileName << Qt::endl;
+        return 1;
+    }
+
+    CatalogWriter writer(&sqlCore);
+    QObject::connect(&writer, &CatalogWriter::progress, [](int done, int total) {
+        err << "\r" << done << " of " << total << " files written" << Qt::flush;
+    });
+
+    const bool ok = writer.write(&file, &root, format);
+    err << Qt::endl;
+    file.close();
+
+    if (!ok) {
+        err << "Error: " << writer.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Console::repack(const QCommandLineParser &parser, const QString &path)
+{
+    bool ok = false;
+    const int level = parser.value("level").toInt(&ok);
+    if (!ok || (level < 0) || (level > 9)) {
+        err << "Error: compression level must be 0..9." << Qt::endl;
+        return 1;
+    }
+
+    SqlCore sqlCore;
+    setup(parser, &sqlCore);
+
+    TreeItem root(0, "ROOT", nullptr);
+
+    if (!sqlCore.load(path, &root)) {
+        err << "Error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    QList<TreeItem*> items;
+    const QStringList paths = parser.values("folder");
+    for (const QString &itemPath : paths) {
+        TreeItem *item = findItem(&root, itemPath);
+        if (!item) {
+            err << "Error: " << itemPath << " not found." << Qt::endl;
+            return 1;
+        }
+        items.append(item);
+    }
+
+    if (items.isEmpty())
+        items.append(&root);
+
+    Repacker repacker(&sqlCore);
+    repacker.setLevel(level);
+    if (parser.isSet("user"))
+        repacker.setCredentials(parser.value("user"), parser.value("password"));
+    QObject::connect(&repacker, &Repacker::progress, [](int done, int total) {
+        err << "\r" << done << " of " << total << " files written" << Qt::flush;
+    });
+
+    ok = repacker.repack(parser.value("repack"), items);
+    err << Qt::endl;
+
+    if (!ok) {
+        err << "Error: " << repacker.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    out << repacker.writtenCount() << " files written, " << repacker.repackedCount() << " recompressed, data "
+        << repacker.inputBytes() << " -> " << repacker.outputBytes() << " bytes." << Qt::endl;
+    return 0;
+}
+
+int Console::recordDiff(const QCommandLineParser &parser, const QString &path)
+{
+    if (!parser.isSet("record-with")) {
+        err << "Error: second file is not set (--record-with)." << Qt::endl;
+        return 2;
+    }
+
+    // Second file is looked up in the same tree unless another database is given
+    SqlCore oldCore, newCore;
+    setup(parser, &oldCore);
+    setup(parser, &newCore);
+
+    TreeItem oldRoot(0, "OLD", nullptr);
+    TreeItem newRoot(0, "NEW", nullptr);
+
+    if (!oldCore.load(path, &oldRoot)) {
+        err << "Error: " << oldCore.lastErrorMsg() << Qt::endl;
+        return 2;
+    }
+
+    SqlCore *newSqlCore = &oldCore;
+    TreeItem *newParent = &oldRoot;
+
+    if (parser.isSet("record-db")) {
+        if (!newCore.load(parser.value("record-db"), &newRoot)) {
+            err << "Error: " << newCore.lastErrorMsg() << Qt::endl;
+            return 2;
+        }
+        newSqlCore = &newCore;
+        newParent = &newRoot;
+    }
+
+    TreeItem *items[2] = { findItem(&oldRoot, parser.value("record-diff")),
+                           findItem(newParent, parser.value("record-with")) };
+    SqlCore *cores[2] = { &oldCore, newSqlCore };
+    QByteArray data[2];
+
+    for (int i = 0; i < 2; i++) {
+        const QString name = parser.value(i ? "record-with" : "record-diff");
+        if (!items[i] || items[i]->isFoler()) {
+            err << "Error: file " << name << " not found." << Qt::endl;
+            return 2;
+        }
+        if (!cores[i]->rawData(items[i], &data[i])) {
+            err << "Error: can't read " << name << ": " << cores[i]->lastErrorMsg() << Qt::endl;
+            return 2;
+        }
+    }
+
+    const QVector<RecordDiff::Range> ranges = RecordDiff::compare(data[0], data[1]);
+
+    for (const RecordDiff::Range &range : ranges)
+        out << QString("%1-%2 %3 bytes")
+                   .arg(range.offset, 8, 16, QChar('0'))
+                   .arg(range.offset + range.length - 1, 8, 16, QChar('0'))
+                   .arg(range.length)
+            << Qt::endl;
+
+    out << ranges.count() << " ranges, " << RecordDiff::length(ranges) << " bytes differ ("
+        << data[0].size() << " and " << data[1].size() << " bytes compared)." << Qt::endl;
+
+    return ranges.isEmpty() ? 0 : 1;
+}
+
+TreeItem *Console::findItem(TreeItem *root, const QString &path)
+{
+    // Record ID
+    if (path.startsWith('#')) {
+        bool ok = false;
+        const int id = path.mid(1).toInt(&ok);
+        return ok ? findItem(root, id) : nullptr;
+    }
+
+    TreeItem *parent = root;
+    const QStringList names = path.split('/', Qt::SkipEmptyParts);
+    for (const QString &name : names) {
+        TreeItem *found = nullptr;
+        for (int i = 0; !found && (i < parent->childCount()); i++)
+            if (parent->childItem(i)->name() == name)
+                found = parent->childItem(i);
+        if (!found)
+            return nullptr;
+        parent = found;
+    }
+
+    return parent;
+}
+
+TreeItem *Console::findItem(TreeItem *parent, int id)
+{
+    for (int i = 0; i < parent->childCount(); i++) {
+        TreeItem *child = parent->childItem(i);
+        TreeItem *found = child->isFoler() ? findItem(child, id) : (child->id() == id ? child : nullptr);
+        if (found)
+            return found;
+    }
+
+    return nullptr;
+}
+
+int Console::mount(const QCommandLineParser &parser, const QString &path)
+{
+#ifdef USE_FUSE
+    SqlCore sqlCore;
+    setup(parser, &sqlCore);
+
+    // Root is named as the database, it is shown as filesystem name
+    TreeItem root(0, QFileInfo(path).completeBaseName(), nullptr);
+
+    if (!sqlCore.load(path, &root)) {
+        err << "Error: " << sqlCore.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    FuseMount fuseMount(&sqlCore, &root);
+    out << sqlCore.fileCount() << " files mounted at " << parser.value("mount")
+        << ", press Ctrl+C to unmount." << Qt::endl;
+
+    if (!fuseMount.exec(parser.value("mount"))) {
+        err << "Error: " << fuseMount.lastErrorMsg() << Qt::endl;
+        return 1;
+    }
+
+    return 0;
+#else
+    Q_UNUSED(parser);
+    Q_UNUSED(path);
+    err << "Error: the application is built without FUSE support (CONFIG+=fuse)." << Qt::endl;
+    return 1;
+#endif
+}
+
+bool Console::parseFilter(const QCommandLineParser &parser, FileFilter *filter)
+{
+    const QStringList kinds = parser.value("kind").split(',', Qt::SkipEmptyParts);
+    for (const QString &kind : kinds) {
+        bool ok = false;
+        int value = kind.toInt(&ok);
+
+        // Data type names without spaces are accepted as well
+        for (int i = TreeItem::RawData; !ok && (i <= TreeItem::InternalData); i++)
+            if (TreeItem::DataTypeToText((TreeItem::DataType)i).remove(' ').compare(kind.trimmed(), Qt::CaseInsensitive) == 0) {
+                value = i;
+                ok = true;
+            }
+
+        if (!ok) {
+            err << "Unknown data type: " << kind << Qt::endl;
+            return false;
+        }
+
+        filter->kinds.append(value);
+    }
+
+    // Date without time covers the whole day
+    for (const bool from : { true, false }) {
+        const QString value = parser.value(from ? "from" : "to");
+        if (value.isEmpty())
+            continue;
+
+        const QDate date = QDate::fromString(value, "yyyy-MM-dd");
+        const QDateTime time = date.isValid() ? (from ? date.startOfDay() : date.endOfDay())
+                                              : QDateTime::fromString(value, Qt::ISODate);
+
+        if (!time.isValid()) {
+            err << "Wrong time: " << value << Qt::endl;
+            return false;
+        }
+
+        if (from)
+            filter->from = time;
+        else
+            filter->to = time;
+    }
+
+    if (parser.isSet("min-size"))
+        filter->minSize = parser.value("min-size").toLongLong();
+    if (parser.isSet("max-size"))
+        filter->maxSize = parser.value("max-size").toLongLong();
+
+    filter->name = parser.value("name");
+
+    return true;
+}
@@ -0,0 +1,42 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "SqlCore/SqlCore.h"
+
+// Console (no GUI) commands of the application
+class Console
+{
+public:
+    // Returns true if command line contains one of console commands,
+    // it must be checked before any application object is created
+    static bool isRequested(int argc, char *argv[]);
+
+    static int exec(QCoreApplication &app);
+
+private:
+    static void setup(const QCommandLineParser &parser, SqlCore *sqlCore);
+    static int convert(const QCommandLineParser &parser, const QString &path);
+    static int diff(const QCommandLineParser &parser, const QString &path);
+    static int verify(const QCommandLineParser &parser, const QString &path);
+    static int exportFiles(const QCommandLineParser &parser, const QString &path);
+    static int mount(const QCommandLineParser &parser, const QString &path);
+    static int catalog(const QCommandLineParser &parser, const QString &path);
+    static int repack(const QCommandLineParser &parser, const QString &path);
+    static int recordDiff(const QCommandLineParser &parser, const QString &path);
+    // Item at "Folder/Subfolder/File" path, or file "#ID", nullptr if not found
+    static TreeItem *findItem(TreeItem *root, const QString &path);
+    static TreeItem *findItem(TreeItem *parent, int id);
+    static bool parseFilter(const QCommandLineParser &parser, FileFilter *filter);
+};
+
+#endif // CONSOLE_H
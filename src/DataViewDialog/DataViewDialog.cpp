@@ -16,15 +16,19 @@
 
 DataViewDialog::DataViewDialog(const QString &fname,
                                bool plainText,
-                               const QByteArray &rawData,
-                               const QByteArray &rawProfile,
                                QWidget *parent)
     : QDialog(parent),
     ui(new Ui::DataViewDialog),
+    m_profileModel(nullptr),
     m_fname(fname),
-    m_rawData(rawData)
+    m_plainText(plainText),
+    m_dataDevice(nullptr),
+    m_textTimer(nullptr),
+    m_textDecoder(nullptr),
+    m_textOffset(0)
 {
     ui->setupUi(this);
+    ui->messageLabel->hide();
 
     // Remove "?" button from window title
     setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
@@ -39,6 +43,7 @@ DataViewDialog::DataViewDialog(const QString &fname,
 
     // Buttons
     connect(ui->exportButton, &QPushButton::clicked, this, &DataViewDialog::exportToFile);
+    ui->exportButton->setEnabled(false);
     connect(ui->closeButton, &QPushButton::clicked, this, &QDialog::accept);
 
     // Monospace font definition
@@ -61,6 +66,7 @@ DataViewDialog::DataViewDialog(const QString &fname,
     m_textEdit->setReadOnly(true);
     m_textEdit->setFont(monoFont);
     m_textEdit->setWordWrapMode(QTextOption::NoWrap);
+    m_textEdit->setUndoRedoEnabled(false); // Don't keep second copy of the text
 
     // Text viewer layout
     QVBoxLayout *vTextLayout = new QVBoxLayout;
@@ -68,14 +74,50 @@ DataViewDialog::DataViewDialog(const QString &fname,
     vTextLayout->setMargin(0);
     vTextLayout->addWidget(m_textEdit);
 
+    // Context menu
+    QAction *m_copyAction = new QAction("Copy as text");
+    connect(m_copyAction, &QAction::triggered, this, &DataViewDialog::copyAsText);
+    QAction *m_copyAllAction = new QAction("Copy all as text");
+    connect(m_copyAllAction, &QAction::triggered, this, &DataViewDialog::copyAllAsText);
+    m_contextMenu = new QMenu(this);
+    m_contextMenu->addAction(m_copyAction);
+    m_contextMenu->addAction(m_copyAllAction);
+    ui->profileView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->profileView, &QTableView::customContextMenuRequested, this, &DataViewDialog::contextMenuRequested);
+
+    // Default tab
+    ui->tabWidget->setCurrentWidget(ui->dataTab);
+    ui->stackedWidget->setCurrentWidget(ui->loadingPage);
+}
+
+DataViewDialog::~DataViewDialog()
+{
+    delete m_textDecoder;
+    delete ui;
+}
+
+void DataViewDialog::setData(RecordDevice *dataDevice, const QByteArray &rawProfile)
+{
+    m_dataDevice = dataDevice;
+    m_dataDevice->setParent(this);
+    ui->exportButton->setEnabled(true);
+
+    // Damaged data is found while viewing, hex viewer shows nothing about it.
+    // Queued, as reads come from painting of the viewer.
+    connect(m_dataDevice, &RecordDevice::readFailed, this, [this](qint64 offset, const QString &errorMsg) {
+        showMessage(QString("Data reading error at offset %1: %2").arg(offset).arg(errorMsg));
+    }, Qt::QueuedConnection);
+
     // Data type selection
-    if (plainText) {
-        QTextStream ts(m_rawData); // This trick also detects encoding
-        m_textEdit->appendPlainText(ts.readAll());
-        m_textEdit->moveCursor(QTextCursor::Start);
+    if (m_plainText) {
+        // Text is loaded chunk by chunk from the event loop
+        m_textTimer = new QTimer(this);
+        connect(m_textTimer, &QTimer::timeout, this, &DataViewDialog::loadTextChunk);
+        m_textTimer->start(0);
         ui->stackedWidget->setCurrentWidget(ui->textPage);
     } else {
-        m_hexEdit->setData(m_rawData);
+        // Hex viewer reads only visible part of the data from the device
+        m_hexEdit->setData(*m_dataDevice);
         ui->stackedWidget->setCurrentWidget(ui->hexPage);
     }
 
@@ -91,25 +133,11 @@ DataViewDialog::DataViewDialog(const QString &fname,
     // Resize first column for better view
     const int w = ui->profileView->horizontalHeader()->width();
     ui->profileView->horizontalHeader()->resizeSection(0, w * 40 / 100);
-
-    // Context menu
-    QAction *m_copyAction = new QAction("Copy as text");
-    connect(m_copyAction, &QAction::triggered, this, &DataViewDialog::copyAsText);
-    QAction *m_copyAllAction = new QAction("Copy all as text");
-    connect(m_copyAllAction, &QAction::triggered, this, &DataViewDialog::copyAllAsText);
-    m_contextMenu = new QMenu(this);
-    m_contextMenu->addAction(m_copyAction);
-    m_contextMenu->addAction(m_copyAllAction);
-    ui->profileView->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(ui->profileView, &QTableView::customContextMenuRequested, this, &DataViewDialog::contextMenuRequested);
-
-    // Default tab
-    ui->tabWidget->setCurrentWidget(ui->dataTab);
 }
 
-DataViewDialog::~DataViewDialog()
+void DataViewDialog::setError(const QString &errorMsg)
 {
-    delete ui;
+    ui->loadingLabel->setText(errorMsg);
 }
 
 void DataViewDialog::contextMenuRequested(QPoint pos)
@@ -137,7 +165,7 @@ void DataViewDialog::copyAllAsText()
 {
     QModelIndex index = ui->profileView->selectionModel()->currentIndex();
 
-    if (!index.isValid())
+    if (!index.isValid() || !m_profileModel)
         return;
 
     QStringList list;
@@ -170,6 +198,85 @@ void DataViewDialog::exportToFile()
         return;
     }
 
-    f.write(m_rawData);
+    // Hex viewer opens and closes the device on each read, so it is closed here
+    if (!m_dataDevice->open(QIODevice::ReadOnly)) {
+        f.remove();
+        QMessageBox::critical(this, "Error", "Data reading error!");
+        return;
+    }
+
+    QString errorMsg;
+    while (errorMsg.isEmpty() && !m_dataDevice->atEnd()) {
+        const QByteArray buf = m_dataDevice->read(RecordDevice::PAGE_SIZE);
+        if (buf.isEmpty())
+            errorMsg = "Data reading error!\n" + m_dataDevice->errorString();
+        else if (f.write(buf) != buf.size())
+            errorMsg = "File writing error!";
+    }
+
+    m_dataDevice->close();
     f.close();
+
+    // Incomplete file is not left behind
+    if (!errorMsg.isEmpty()) {
+        f.remove();
+        QMessageBox::critical(this, "Error", errorMsg);
+    }
+}
+
+void DataViewDialog::showMessage(const QString &text)
+{
+    ui->messageLabel->setText(text);
+    ui->messageLabel->setVisible(true);
+}
+
+void DataViewDialog::loadTextChunk()
+{
+    const int chunkSize = 0x40000; // 256 KiB per event loop iteration
+
+    QByteArray chunk;
+    if (m_dataDevice->open(QIODevice::ReadOnly)) {
+        m_dataDevice->seek(m_textOffset);
+        chunk = m_dataDevice->read(chunkSize);
+        m_dataDevice->close();
+    }
+
+    if (chunk.isEmpty()) {
+        m_textTimer->stop();
+
+        if (m_textOffset < m_dataDevice->size())
+            showMessage(QString("Data reading error at offset %1, the text is incomplete!").arg(m_textOffset));
+
+        if (!m_textTail.isEmpty()) {
+            QTextCursor cursor(m_textEdit->document());
+            cursor.movePosition(QTextCursor::End);
+            cursor.insertText(m_textTail);
+            m_textTail.clear();
+        }
+        return;
+    }
+
+    // Encoding is detected by the first chunk the same way QTextStream does it,
+    // decoder keeps multibyte sequences split between chunks
+    if (!m_textDecoder) {
+        QTextCodec *codec = QTextCodec::codecForUtfText(chunk, QTextCodec::codecForLocale());
+        m_textDecoder = codec->makeDecoder();
+    }
+
+    m_textOffset += chunk.size();
+
+    // CR LF split between chunks would be inserted as two line breaks
+    QString text = m_textTail + m_textDecoder->toUnicode(chunk);
+    m_textTail.clear();
+    if (text.endsWith('\r') && (m_textOffset < m_dataDevice->size())) {
+        m_textTail = text.right(1);
+        text.chop(1);
+    }
+
+    QTextCursor cursor(m_textEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+
+    if (m_textOffset == chunk.size())
+        m_textEdit->moveCursor(QTextCursor::Start);
 }
@@ -12,8 +12,11 @@
 #include <QDialog>
 #include "qhexedit.h"
 #include "ProfileModel/ProfileModel.h"
+#include "RecordDevice/RecordDevice.h"
 #include <QPlainTextEdit>
 #include <QMenu>
+#include <QTimer>
+#include <QTextDecoder>
 
 namespace Ui {
 class DataViewDialog;
@@ -24,13 +27,18 @@ class DataViewDialog : public QDialog
     Q_OBJECT
 
 public:
+    // Dialog is shown with "Loading..." page until setData() or setError() call
     explicit DataViewDialog(const QString &fname,
                             bool plainText,
-                            const QByteArray &rawData,
-                            const QByteArray &rawProfile,
                             QWidget *parent = nullptr);
     ~DataViewDialog();
 
+    // Dialog takes ownership of the data device
+    void setData(RecordDevice *dataDevice, const QByteArray &rawProfile);
+    void setError(const QString &errorMsg);
+    // Problem with the data is shown under the tabs, not in a message box
+    void showMessage(const QString &text);
+
 private:
     Ui::DataViewDialog *ui;
     QHexEdit *m_hexEdit;
@@ -39,13 +47,21 @@ private:
     QMenu *m_contextMenu;
 
     QString m_fname;
-    QByteArray m_rawData;
+    bool m_plainText;
+    RecordDevice *m_dataDevice;
+
+    // Plain text is decoded and appended in chunks while the dialog is shown
+    QTimer *m_textTimer;
+    QTextDecoder *m_textDecoder;
+    qint64 m_textOffset;
+    QString m_textTail;     // Trailing CR waits for LF of the next chunk
 
 private slots:
     void contextMenuRequested(QPoint pos);
     void copyAsText();
     void copyAllAsText();
     void exportToFile();
+    void loadTextChunk();
 };
 
 #endif // DATAVIEWDIALOG_H
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "DbDiff.h"
+#include <QCryptographicHash>
+#include "BatchPipeline/BatchPipeline.h"
+#include "InflateContext/InflateContext.h"
+
+struct HashJob {
+    QByteArray oldBlob;
+    QByteArray newBlob;
+    QString reason;
+};
+
+// Hash of uncompressed data, BLOB is inflated chunk by chunk
+// so memory use doesn't depend on the record size
+static QByteArray contentHash(const QByteArray &blob)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    const qint64 inflated = InflateContext::local()->streamBlob(blob, [&hash](const char *data, int size) {
+        hash.addData(data, size);
+    });
+
+    return (inflated >= 0) ? hash.result() : QByteArray();
+}
+
+static void hashJob(HashJob &job)
+{
+    // Equal compressed data means equal content, nothing to inflate
+    if (job.oldBlob == job.newBlob)
+        return;
+
+    const QByteArray oldHash = contentHash(job.oldBlob);
+    const QByteArray newHash = contentHash(job.newBlob);
+
+    if (oldHash.isEmpty() || newHash.isEmpty())
+        job.reason = "unreadable";
+    else if (oldHash != newHash)
+        job.reason = "content";
+}
+
+DbDiff::DbDiff(SqlCore *oldCore, SqlCore *newCore, QObject *parent)
+    : QObject{parent},
+    m_oldCore(oldCore),
+    m_newCore(newCore),
+    m_unchangedCount(0),
+    m_hashedCount(0),
+    m_canceled(false)
+{
+
+}
+
+bool DbDiff::compare(TreeItem *oldParent, TreeItem *newParent, bool fullContent)
+{
+    m_entries.clear();
+    m_unchangedCount = 0;
+    m_hashedCount = 0;
+    m_canceled = false;
+    m_lastErrorMsg.clear();
+
+    QHash<QString, TreeItem*> oldFiles, newFiles;
+    collect(oldParent, &oldFiles);
+    collect(newParent, &newFiles);
+
+    QStringList paths = oldFiles.keys();
+    paths.sort();
+
+    QVector<QPair<TreeItem*, TreeItem*>> pairs;
+    QStringList pairPaths;
+
+    // Metadata comparison
+    for (const QString &path : paths) {
+        TreeItem *oldItem = oldFiles.value(path);
+        TreeItem *newItem = newFiles.value(path, nullptr);
+
+        if (!newItem)
+            m_entries.append({ Removed, path, oldItem, nullptr, QString() });
+        else if (oldItem->size() != newItem->size())
+            m_entries.append({ Changed, path, oldItem, newItem, "size" });
+        else if (oldItem->type() != newItem->type())
+            m_entries.append({ Changed, path, oldItem, newItem, "kind" });
+        else if (fullContent || (oldItem->ctime() != newItem->ctime())) {
+            pairs.append({ oldItem, newItem });
+            pairPaths.append(path);
+        } else
+            m_unchangedCount++;
+    }
+
+    paths = newFiles.keys();
+    paths.sort();
+
+    for (const QString &path : paths)
+        if (!oldFiles.contains(path))
+            m_entries.append({ Added, path, nullptr, newFiles.value(path), QString() });
+
+    // Content comparison
+    QStringList reasons;
+    if (!compareContent(pairs, &reasons))
+        return false;
+
+    for (int i = 0; i < pairs.count(); i++) {
+        if (reasons.at(i).isEmpty())
+            m_unchangedCount++;
+        else
+            m_entries.append({ Changed, pairPaths.at(i), pairs.at(i).first, pairs.at(i).second, reasons.at(i) });
+    }
+
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.path < b.path; });
+
+    return true;
+}
+
+int DbDiff::count(Change change) const
+{
+    return std::count_if(m_entries.cbegin(), m_entries.cend(),
+                         [change](const Entry &entry) { return entry.change == change; });
+}
+
+QString DbDiff::changeToText(Change change)
+{
+    switch (change) {
+    case Added:
+        return "Added";
+    case Removed:
+        return "Removed";
+    case Changed:
+        return "Changed";
+    }
+
+    return QString();
+}
+
+void DbDiff::collect(TreeItem *parentItem, QHash<QString, TreeItem*> *files)
+{
+    QVector<QPair<TreeItem*, QString>> list;
+    BatchPipeline::collectFiles(parentItem, QString(), &list);
+
+    for (const auto &file : qAsConst(list)) {
+        // Duplicate names are matched in database order
+        QString path = file.second;
+        for (int n = 2; files->contains(path); n++)
+            path = QString("%1#%2").arg(file.second).arg(n);
+
+        files->insert(path, file.first);
+    }
+}
+
+bool DbDiff::compareContent(const QVector<QPair<TreeItem*, TreeItem*>> &pairs, QStringList *reasons)
+{
+    if (pairs.isEmpty())
+        return true;
+
+    StorageBackend *oldBackend = m_oldCore->backend();
+    StorageBackend *newBackend = m_newCore->backend();
+
+    if (!oldBackend || !newBackend) {
+        m_lastErrorMsg = !oldBackend ? m_oldCore->lastErrorMsg() : m_newCore->lastErrorMsg();
+        return false;
+    }
+
+    auto fetch = [&](int index, HashJob &job) {
+        job.oldBlob = oldBackend->blob(pairs.at(index).first->id(), "DATA");
+        job.newBlob = newBackend->blob(pairs.at(index).second->id(), "DATA");
+        return (qint64)job.oldBlob.size() + job.newBlob.size();
+    };
+
+    auto done = [&](const QVector<HashJob> &batch, int) {
+        for (const HashJob &job : batch)
+            reasons->append(job.reason);
+
+        m_hashedCount = reasons->count();
+        emit progress(m_hashedCount, pairs.count());
+
+        if (m_canceled) {
+            m_lastErrorMsg = "Canceled by user.";
+            return false;
+        }
+
+        return true;
+    };
+
+    return BatchPipeline::run(pairs.count(), fetch, hashJob, done);
+}    return true;
+}
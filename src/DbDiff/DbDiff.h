@@ -0,0 +1,70 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef DBDIFF_H
+#define DBDIFF_H
+
+#include <QObject>
+#include "SqlCore/SqlCore.h"
+#include "TreeItem/TreeItem.h"
+
+// Structural and content comparison of two databases. Files are matched
+// by path, metadata is compared first, decompressed data is hashed
+// in parallel only when metadata can't tell the difference.
+class DbDiff : public QObject
+{
+    Q_OBJECT
+public:
+    enum Change { Added, Removed, Changed };
+
+    struct Entry {
+        Change change;
+        QString path;
+        TreeItem *oldItem;  // nullptr for added files
+        TreeItem *newItem;  // nullptr for removed files
+        QString reason;     // What is changed: size, kind or content
+    };
+
+    explicit DbDiff(SqlCore *oldCore, SqlCore *newCore, QObject *parent = nullptr);
+
+    // Compares two trees (children of database name items). Matched files of
+    // equal size and kind are compared by content if their creation time
+    // differs, or always if full content comparison is requested.
+    bool compare(TreeItem *oldParent, TreeItem *newParent, bool fullContent);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+    const QVector<Entry> &entries() const { return m_entries; }
+    int count(Change change) const;
+    int unchangedCount() const { return m_unchangedCount; }
+    // Number of file pairs compared by content
+    int hashedCount() const { return m_hashedCount; }
+
+    static QString changeToText(Change change);
+
+signals:
+    // Content comparison progress
+    void progress(int done, int total);
+
+public slots:
+    void cancel() { m_canceled = true; }
+
+private:
+    SqlCore *m_oldCore;
+    SqlCore *m_newCore;
+    QVector<Entry> m_entries;
+    int m_unchangedCount;
+    int m_hashedCount;
+    bool m_canceled;
+    QString m_lastErrorMsg;
+
+    static void collect(TreeItem *parentItem, QHash<QString, TreeItem*> *files);
+    // Fills reasons of difference, empty string for equal content
+    bool compareContent(const QVector<QPair<TreeItem*, TreeItem*>> &pairs, QStringList *reasons);
+};
+
+#endif // DBDIFF_H
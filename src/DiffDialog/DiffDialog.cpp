@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "DiffDialog.h"
+#include "ui_DiffDialog.h"
+
+DiffDialog::DiffDialog(const QString &oldName,
+                       const QString &newName,
+                       const DbDiff &dbDiff,
+                       QWidget *parent)
+    : QDialog(parent),
+    ui(new Ui::DiffDialog)
+{
+    ui->setupUi(this);
+
+    // Remove "?" button from window title
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    setWindowTitle(QString("Compare: %1 - %2").arg(oldName).arg(newName));
+
+    connect(ui->closeButton, &QPushButton::clicked, this, &QDialog::accept);
+
+    ui->summaryLabel->setText(QString("Added: %1, removed: %2, changed: %3, unchanged: %4")
+                                  .arg(dbDiff.count(DbDiff::Added))
+                                  .arg(dbDiff.count(DbDiff::Removed))
+                                  .arg(dbDiff.count(DbDiff::Changed))
+                                  .arg(dbDiff.unchangedCount()));
+
+    // One group per change type, items are built in one go
+    QList<QTreeWidgetItem*> groups;
+    for (DbDiff::Change change : { DbDiff::Added, DbDiff::Removed, DbDiff::Changed }) {
+        QTreeWidgetItem *group = new QTreeWidgetItem;
+        group->setText(0, QString("%1 (%2)").arg(DbDiff::changeToText(change)).arg(dbDiff.count(change)));
+        groups.append(group);
+    }
+
+    for (const DbDiff::Entry &entry : dbDiff.entries()) {
+        QTreeWidgetItem *item = new QTreeWidgetItem;
+        item->setText(0, entry.path);
+        item->setText(1, entry.reason);
+        if (entry.oldItem)
+            item->setText(2, QString::number(entry.oldItem->size()));
+        if (entry.newItem)
+            item->setText(3, QString::number(entry.newItem->size()));
+        item->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+        item->setTextAlignment(3, Qt::AlignRight | Qt::AlignVCenter);
+        groups.at(entry.change)->addChild(item);
+    }
+
+    for (int i = groups.count() - 1; i >= 0; i--)
+        if (groups.at(i)->childCount() == 0)
+            delete groups.takeAt(i);
+
+    ui->diffTree->addTopLevelItems(groups);
+    ui->diffTree->expandAll();
+
+    // Resize first column for better view
+    ui->diffTree->header()->resizeSection(0, width() * 60 / 100);
+}
+
+DiffDialog::~DiffDialog()
+{
+    delete ui;
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef DIFFDIALOG_H
+#define DIFFDIALOG_H
+
+#include <QDialog>
+#include "DbDiff/DbDiff.h"
+
+namespace Ui {
+class DiffDialog;
+}
+
+// Shows added, removed and changed files of two databases
+class DiffDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DiffDialog(const QString &oldName,
+                        const QString &newName,
+                        const DbDiff &dbDiff,
+                        QWidget *parent = nullptr);
+    ~DiffDialog();
+
+private:
+    Ui::DiffDialog *ui;
+};
+
+#endif // DIFFDIALOG_H
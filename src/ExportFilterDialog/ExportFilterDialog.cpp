@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "ExportFilterDialog.h"
+#include "ui_ExportFilterDialog.h"
+#include "TreeItem/TreeItem.h"
+
+ExportFilterDialog::ExportFilterDialog(const QString &folderName, QWidget *parent)
+    : QDialog(parent),
+    ui(new Ui::ExportFilterDialog)
+{
+    ui->setupUi(this);
+
+    // Remove "?" button from window title
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    ui->folderLabel->setText(folderName);
+
+    // Nothing checked means any data type
+    for (int kind = TreeItem::RawData; kind <= TreeItem::InternalData; kind++) {
+        QListWidgetItem *item = new QListWidgetItem(TreeItem::DataTypeToText((TreeItem::DataType)kind), ui->kindList);
+        item->setData(Qt::UserRole, kind);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    ui->fromEdit->setDateTime(now.addYears(-1));
+    ui->toEdit->setDateTime(now);
+
+    connect(ui->fromCheck, &QCheckBox::toggled, ui->fromEdit, &QWidget::setEnabled);
+    connect(ui->toCheck, &QCheckBox::toggled, ui->toEdit, &QWidget::setEnabled);
+    connect(ui->minSizeCheck, &QCheckBox::toggled, ui->minSizeSpin, &QWidget::setEnabled);
+    connect(ui->maxSizeCheck, &QCheckBox::toggled, ui->maxSizeSpin, &QWidget::setEnabled);
+}
+
+ExportFilterDialog::~ExportFilterDialog()
+{
+    delete ui;
+}
+
+FileFilter ExportFilterDialog::filter() const
+{
+    FileFilter filter;
+
+    for (int i = 0; i < ui->kindList->count(); i++) {
+        const QListWidgetItem *item = ui->kindList->item(i);
+        if (item->checkState() == Qt::Checked)
+            filter.kinds.append(item->data(Qt::UserRole).toInt());
+    }
+
+    if (ui->fromCheck->isChecked())
+        filter.from = ui->fromEdit->dateTime();
+    if (ui->toCheck->isChecked())
+        filter.to = ui->toEdit->dateTime();
+    if (ui->minSizeCheck->isChecked())
+        filter.minSize = ui->minSizeSpin->value();
+    if (ui->maxSizeCheck->isChecked())
+        filter.maxSize = ui->maxSizeSpin->value();
+
+    filter.name = ui->nameEdit->text().trimmed();
+
+    return filter;
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef EXPORTFILTERDIALOG_H
+#define EXPORTFILTERDIALOG_H
+
+#include <QDialog>
+#include "StorageBackend/StorageBackend.h"
+
+namespace Ui {
+class ExportFilterDialog;
+}
+
+// Conditions of selective export: data types, creation time,
+// size range and name pattern of files in the folder
+class ExportFilterDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ExportFilterDialog(const QString &folderName, QWidget *parent = nullptr);
+    ~ExportFilterDialog();
+
+    FileFilter filter() const;
+
+private:
+    Ui::ExportFilterDialog *ui;
+};
+
+#endif // EXPORTFILTERDIALOG_H
@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Exporter.h"
+#include "Tracer/Tracer.h"
+
+Exporter::Exporter(SqlCore *sqlCore, FileWriter::Kind writerKind) :
+    m_sqlCore(sqlCore),
+    m_writerKind(writerKind),
+    m_order(StorageOrder),
+    m_sparse(true),
+    m_writer(nullptr),
+    m_exportedCount(0)
+{
+
+}
+
+bool Exporter::exportItems(const QDir &dir, TreeItem *parent)
+{
+    TRACE_SCOPE("export");
+
+    QScopedPointer<FileWriter> writer(FileWriter::create(m_writerKind));
+    m_writer = writer.data();
+    m_writer->setSparse(m_sparse);
+    m_exportedCount = 0;
+    m_fillStats = FileWriter::FillStats();
+    m_lastErrorMsg.clear();
+
+    bool ok = true;
+    if (m_order == StorageOrder)
+        exportStorageOrder(dir, parent, &ok);
+    else
+        exportTreeItems(dir, parent, &ok);
+
+    // Queued files are written by now
+    {
+        TRACE_SCOPE("export finish");
+        if (!m_writer->finish())
+            ok = false;
+    }
+
+    m_fillStats = m_writer->fillStats();
+    m_writer = nullptr;
+
+    return ok;
+}
+
+void Exporter::exportTreeItems(QDir dir, TreeItem *parent, bool *ok)
+{
+    for (int i = 0; i < parent->childCount(); i++) {
+        TreeItem *child = parent->childItem(i);
+        if (child->isFoler()) {
+            if (dir.mkdir(child->name())) {
+                dir.cd(child->name());
+                // Recursion to export subdirs
+                exportTreeItems(dir, child, ok);
+                dir.cdUp();
+            } else
+                *ok = false;
+        } else if (!exportFile(dir.absolutePath() + QDir::separator() + child->name(), child))
+            *ok = false;
+    }
+}
+
+void Exporter::exportStorageOrder(const QDir &dir, TreeItem *parent, bool *ok)
+{
+    QHash<int, QString> folderPaths;
+    QHash<int, TreeItem*> files;
+    collect(parent, QString(), &folderPaths, &files);
+
+    // All folders first, a parent path sorts before paths of its subfolders
+    QStringList paths = folderPaths.values();
+    paths.sort();
+    for (const QString &path : qAsConst(paths))
+        if (!path.isEmpty() && !dir.mkdir(path))
+            *ok = false;
+
+    // Records are read in storage order, the writer puts each one to its tree path
+    QVector<int> ids = files.keys().toVector();
+    sortByStorage(&ids);
+
+    for (int id : qAsConst(ids)) {
+        TreeItem *item = files.value(id);
+        const QString folderPath = folderPaths.value(item->parentItem()->id());
+        if (!exportFile(dir.absoluteFilePath(folderPath + item->name()), item))
+            *ok = false;
+    }
+}
+
+void Exporter::sortByStorage(QVector<int> *ids)
+{
+    TRACE_SCOPE("export order");
+
+    StorageBackend *backend = m_sqlCore->backend();
+    if (backend)
+        backend->sortByStorage(ids);
+    else
+        std::sort(ids->begin(), ids->end());
+}
+
+bool Exporter::exportFiltered(const QDir &dir, TreeItem *parent, FileFilter filter)
+{
+    TRACE_SCOPE("export filtered");
+
+    m_exportedCount = 0;
+    m_fillStats = FileWriter::FillStats();
+    m_lastErrorMsg.clear();
+
+    // Paths come from the tree, the database gives IDs of matching files only
+    QHash<int, QString> folderPaths;
+    QHash<int, TreeItem*> files;
+    collect(parent, QString(), &folderPaths, &files);
+
+    // Database root (ID 0) needs no folder condition at all
+    filter.folderIds.clear();
+    if (parent->id() != 0)
+        filter.folderIds = folderPaths.keys().toVector();
+
+    StorageBackend *backend = m_sqlCore->backend();
+    QVector<FileRecord> records;
+
+    if (!backend) {
+        m_lastErrorMsg = m_sqlCore->lastErrorMsg();
+        return false;
+    }
+
+    if (!backend->findFiles(filter, &records)) {
+        m_lastErrorMsg = backend->lastErrorMsg();
+        return false;
+    }
+
+    QScopedPointer<FileWriter> writer(FileWriter::create(m_writerKind));
+    m_writer = writer.data();
+    m_writer->setSparse(m_sparse);
+
+    // Matching files come in no particular order
+    QVector<int> ids;
+    ids.reserve(records.count());
+    for (const FileRecord &record : qAsConst(records))
+        ids.append(record.id);
+    if (m_order == StorageOrder)
+        sortByStorage(&ids);
+
+    bool ok = true;
+    QSet<QString> createdPaths;
+
+    for (int id : qAsConst(ids)) {
+        // Files added after the catalog was loaded are skipped
+        TreeItem *item = files.value(id);
+        if (!item)
+            continue;
+
+        const QString folderPath = folderPaths.value(item->parentItem()->id());
+        if (!createdPaths.contains(folderPath)) {
+            if (!dir.mkpath(folderPath.isEmpty() ? "." : folderPath)) {
+                ok = false;
+                continue;
+            }
+            createdPaths.insert(folderPath);
+        }
+
+        if (!exportFile(dir.absoluteFilePath(folderPath + item->name()), item))
+            ok = false;
+    }
+
+    // Queued files are written by now
+    if (!m_writer->finish())
+        ok = false;
+
+    m_fillStats = m_writer->fillStats();
+    m_writer = nullptr;
+
+    if (!ok)
+        m_lastErrorMsg = "Some files or folders were not written.";
+
+    return ok;
+}
+
+bool Exporter::exportFile(const QString &path, TreeItem *item)
+{
+    bool ok = true;
+
+    // Writer may keep the data until finish(), then the buffer is detached
+    // and the next rawData() call allocates a new one
+    if (!m_sqlCore->rawData(item, &m_buffer) || (m_buffer.size() != item->size()))
+        ok = false;
+    if (!m_writer->write(path, m_buffer))
+        ok = false;
+
+    if (ok)
+        m_exportedCount++;
+
+    return ok;
+}
+
+void Exporter::collect(TreeItem *parent, const QString &path,
+                       QHash<int, QString> *folderPaths,
+                       QHash<int, TreeItem*> *files)
+{
+    // Path of the folder relative to the export directory, with trailing separator
+    folderPaths->insert(parent->id(), path);
+
+    for (int i = 0; i < parent->childCount(); i++) {
+        TreeItem *child = parent->childItem(i);
+        if (child->isFoler())
+            collect(child, path + child->name() + "/", folderPaths, files);
+        else
+            files->insert(child->id(), child);
+    }
+}
+
+QString Exporter::fillToText(const FileWriter::FillStats &stats)
+{
+    if (!stats.bytes)
+        return QString();
+
+    auto percent = [&stats](qint64 bytes) {
+        return QString("%1%").arg(100.0 * bytes / stats.bytes, 0, 'f', 1);
+    };
+
+    return QString("%1 0x00 (%2 in holes), %3 0xFF")
+        .arg(percent(stats.zeroBytes))
+        .arg(percent(stats.holeBytes))
+        .arg(percent(stats.ffBytes));
+}
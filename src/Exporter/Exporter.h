@@ -0,0 +1,68 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <QtCore>
+#include "SqlCore/SqlCore.h"
+#include "TreeItem/TreeItem.h"
+#include "FileWriter/FileWriter.h"
+
+class Exporter
+{
+public:
+    // Order records are read from the database: depth-first as the tree is
+    // shown, or as BLOBs are stored in the file (see StorageBackend::sortByStorage()),
+    // which keeps read-ahead of disks and network shares useful
+    enum Order { TreeOrder, StorageOrder };
+
+    explicit Exporter(SqlCore *sqlCore, FileWriter::Kind writerKind = FileWriter::FastestWriter);
+
+    void setOrder(Order order) { m_order = order; }
+    Order order() const { return m_order; }
+    // Long zero runs become holes, see FileWriter
+    void setSparse(bool sparse) { m_sparse = sparse; }
+
+    // Exports all children of the parent item into the directory,
+    // returns false if at least one file or folder failed
+    bool exportItems(const QDir &dir, TreeItem *parent);
+    // Exports files of the parent item subtree matching the filter, folder
+    // structure is kept. The filter is applied by the database, so only
+    // matching files are fetched and inflated. Folder IDs of the filter
+    // are replaced by the subtree.
+    bool exportFiltered(const QDir &dir, TreeItem *parent, FileFilter filter);
+
+    // Number of files written by the last export
+    int exportedCount() const { return m_exportedCount; }
+    // Padding found in files of the last export
+    FileWriter::FillStats fillStats() const { return m_fillStats; }
+    // Fill ratios as text, like "12.5% 0x00 (8.0% in holes), 3.1% 0xFF"
+    static QString fillToText(const FileWriter::FillStats &stats);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+private:
+    SqlCore *m_sqlCore;
+    FileWriter::Kind m_writerKind;
+    Order m_order;
+    bool m_sparse;
+    FileWriter::FillStats m_fillStats;
+    FileWriter *m_writer;
+    QByteArray m_buffer; // Reused for every file, grows up to the largest one
+    int m_exportedCount;
+    QString m_lastErrorMsg;
+    void exportTreeItems(QDir dir, TreeItem *parent, bool *ok);
+    void exportStorageOrder(const QDir &dir, TreeItem *parent, bool *ok);
+    void sortByStorage(QVector<int> *ids);
+    bool exportFile(const QString &path, TreeItem *item);
+    static void collect(TreeItem *parent, const QString &path,
+                        QHash<int, QString> *folderPaths,
+                        QHash<int, TreeItem*> *files);
+};
+
+#endif // EXPORTER_H
@@ -0,0 +1,192 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "FileWriter.h"
+#include "Tracer/Tracer.h"
+#include "PoolFileWriter/PoolFileWriter.h"
+#ifdef USE_LIBURING
+#include "UringFileWriter/UringFileWriter.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FILEWRITER_SSE2
+#endif
+
+bool FileWriter::write(const QString &path, const QByteArray &data)
+{
+    return writeFile(path, data);
+}
+
+FileWriter *FileWriter::create(Kind kind)
+{
+#ifdef USE_LIBURING
+    if ((kind == UringWriter) || (kind == FastestWriter)) {
+        UringFileWriter *writer = new UringFileWriter;
+        if (writer->isReady())
+            return writer;
+        // Old kernel or io_uring is disabled
+        delete writer;
+    }
+#endif
+
+    if (kind != SyncWriter)
+        return new PoolFileWriter;
+
+    return new FileWriter;
+}
+
+FileWriter::FillStats FileWriter::fillStats() const
+{
+    FillStats stats;
+    stats.bytes = m_bytes.loadRelaxed();
+    stats.zeroBytes = m_zeroBytes.loadRelaxed();
+    stats.ffBytes = m_ffBytes.loadRelaxed();
+    stats.holeBytes = m_holeBytes.loadRelaxed();
+    return stats;
+}
+
+bool FileWriter::writeFile(const QString &path, const QByteArray &data)
+{
+    TRACE_SCOPE("write file");
+
+    QFile f(path);
+
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+
+    const char *p = data.constData();
+    const qint64 size = data.size();
+    qint64 zeroBytes = 0, ffBytes = 0, holeBytes = 0;
+    qint64 written = 0;     // Data before it is written or skipped
+    qint64 runStart = -1;   // Current run of zero blocks
+    bool ok = true;
+
+    // Hole [runStart, end) is skipped if it is long enough
+    auto skipRun = [&](qint64 end) {
+        if (m_sparse && (runStart >= 0) && (end - runStart >= MIN_HOLE)) {
+            if (runStart > written)
+                ok = ok && f.seek(written) && (f.write(p + written, runStart - written) == runStart - written);
+            holeBytes += end - runStart;
+            written = end;
+        }
+        runStart = -1;
+    };
+
+    for (qint64 pos = 0; pos < size; pos += FILL_BLOCK) {
+        const qint64 length = qMin<qint64>(FILL_BLOCK, size - pos);
+        const int fill = (length == FILL_BLOCK) ? blockFill(p + pos, length) : -1;
+
+        if (fill == 0x00) {
+            zeroBytes += length;
+            if (runStart < 0)
+                runStart = pos;
+            continue;
+        }
+
+        if (fill == 0xFF)
+            ffBytes += length;
+        skipRun(pos);
+    }
+    skipRun(size);
+
+    if (written < size)
+        ok = ok && f.seek(written) && (f.write(p + written, size - written) == size - written);
+    // Trailing hole
+    if (f.size() < size)
+        ok = ok && f.resize(size);
+    f.close();
+
+    m_bytes.fetchAndAddRelaxed(size);
+    m_zeroBytes.fetchAndAddRelaxed(zeroBytes);
+    m_ffBytes.fetchAndAddRelaxed(ffBytes);
+    m_holeBytes.fetchAndAddRelaxed(holeBytes);
+    Tracer::count("bytes written", size - holeBytes);
+    Tracer::count("bytes in holes", holeBytes);
+
+    return ok;
+}
+
+void FileWriter::countFill(const QByteArray &data)
+{
+    qint64 zeroBytes = 0, ffBytes = 0;
+
+    for (qint64 pos = 0; pos + FILL_BLOCK <= data.size(); pos += FILL_BLOCK) {
+        const int fill = blockFill(data.constData() + pos, FILL_BLOCK);
+        if (fill == 0x00)
+            zeroBytes += FILL_BLOCK;
+        else if (fill == 0xFF)
+            ffBytes += FILL_BLOCK;
+    }
+
+    m_bytes.fetchAndAddRelaxed(data.size());
+    m_zeroBytes.fetchAndAddRelaxed(zeroBytes);
+    m_ffBytes.fetchAndAddRelaxed(ffBytes);
+    Tracer::count("bytes written", data.size());
+}
+
+bool FileWriter::hasHole(const QByteArray &data) const
+{
+    if (!m_sparse || (data.size() < MIN_HOLE))
+        return false;
+
+    qint64 run = 0;
+
+    for (qint64 pos = 0; pos + FILL_BLOCK <= data.size(); pos += FILL_BLOCK) {
+        if (blockFill(data.constData() + pos, FILL_BLOCK) != 0x00) {
+            run = 0;
+            continue;
+        }
+
+        run += FILL_BLOCK;
+        if (run >= MIN_HOLE)
+            return true;
+    }
+
+    return false;
+}
+
+int FileWriter::blockFill(const char *data, qint64 size)
+{
+    if (size <= 0)
+        return -1;
+
+    const uchar first = data[0];
+    if ((first != 0x00) && (first != 0xFF))
+        return -1;
+
+    qint64 i = 0;
+
+#ifdef FILEWRITER_SSE2
+    // Bytes equal to the first one, checked 64 bytes per step
+    const __m128i value = _mm_set1_epi8((char)first);
+    for (; i + 64 <= size; i += 64) {
+        const __m128i *p = (const __m128i *)(data + i);
+        const __m128i equal = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(p), value),
+                                                          _mm_cmpeq_epi8(_mm_loadu_si128(p + 1), value)),
+                                            _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(p + 2), value),
+                                                          _mm_cmpeq_epi8(_mm_loadu_si128(p + 3), value)));
+        if (_mm_movemask_epi8(equal) != 0xFFFF)
+            return -1;
+    }
+#else
+    const quint64 value = first ? ~Q_UINT64_C(0) : 0;
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word != value)
+            return -1;
+    }
+#endif
+
+    for (; i < size; i++)
+        if ((uchar)data[i] != first)
+            return -1;
+
+    return first;
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include <QtCore>
+
+// Writes whole files for export. This base class writes synchronously
+// with QFile, subclasses queue writes and complete them in finish().
+// Long runs of zero blocks are skipped with seek, so padded dumps become
+// sparse files on file systems supporting holes.
+class FileWriter
+{
+public:
+    enum {
+        FILL_BLOCK = 4096,      // Run detection unit, file system block
+        MIN_HOLE = 0x10000      // Shorter zero runs are written
+    };
+
+    // Padding in written data, whole blocks only
+    struct FillStats {
+        qint64 bytes = 0;       // All bytes written
+        qint64 zeroBytes = 0;   // Blocks of 0x00
+        qint64 ffBytes = 0;     // Blocks of 0xFF
+        qint64 holeBytes = 0;   // Zero blocks skipped as holes
+    };
+
+    enum Kind {
+        SyncWriter,     // QFile, one file at a time
+        PoolWriter,     // QFile on a thread pool
+        UringWriter,    // Batched io_uring submits, Linux only
+        FastestWriter   // The fastest one available
+    };
+
+    virtual ~FileWriter() {}
+
+    virtual QString name() const { return "sync"; }
+    // Returns false if the file is known to be failed already,
+    // queued writes are checked by finish()
+    virtual bool write(const QString &path, const QByteArray &data);
+    // Waits for all queued writes, returns false if any of them failed
+    virtual bool finish() { return true; }
+
+    // Holes are made by default
+    void setSparse(bool sparse) { m_sparse = sparse; }
+    bool isSparse() const { return m_sparse; }
+    // Totals of files written so far
+    FillStats fillStats() const;
+
+    // Falls back to the next slower kind if the requested one is unavailable
+    static FileWriter *create(Kind kind = FastestWriter);
+
+protected:
+    // Thread safe, called by pool threads
+    bool writeFile(const QString &path, const QByteArray &data);
+    // Adds data to fill statistics for writers not using writeFile()
+    void countFill(const QByteArray &data);
+    // True if sparse writing is on and writeFile() would leave a hole
+    // in the data, stops at the first long enough zero run
+    bool hasHole(const QByteArray &data) const;
+
+private:
+    bool m_sparse = true;
+    QAtomicInteger<qint64> m_bytes = 0;
+    QAtomicInteger<qint64> m_zeroBytes = 0;
+    QAtomicInteger<qint64> m_ffBytes = 0;
+    QAtomicInteger<qint64> m_holeBytes = 0;
+
+    // 0x00 or 0xFF if all bytes are equal to it, -1 otherwise
+    static int blockFill(const char *data, qint64 size);
+};
+
+#endif // FILEWRITER_H
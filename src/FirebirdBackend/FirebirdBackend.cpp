@@ -0,0 +1,31 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "FirebirdBackend.h"
+
+FirebirdBackend::FirebirdBackend() :
+    SqlBackend("QIBASE"),
+    m_user(qEnvironmentVariable("ISC_USER", "SYSDBA")),
+    m_password(qEnvironmentVariable("ISC_PASSWORD", "masterkey"))
+{
+
+}
+
+void FirebirdBackend::setCredentials(const QString &user, const QString &password)
+{
+    m_user = user;
+    m_password = password;
+}
+
+bool FirebirdBackend::open(const QString &path)
+{
+    m_db.setUserName(m_user);
+    m_db.setPassword(m_password);
+
+    return SqlBackend::open(path);
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef FIREBIRDBACKEND_H
+#define FIREBIRDBACKEND_H
+
+#include "SqlBackend/SqlBackend.h"
+
+// Original PC-3000 database files (*.pcr & *.fdb) over the QIBASE driver
+class FirebirdBackend : public SqlBackend
+{
+public:
+    FirebirdBackend();
+
+    // Default credentials are taken from ISC_USER & ISC_PASSWORD environment
+    // variables, "SYSDBA" & "masterkey" if they are not set
+    void setCredentials(const QString &user, const QString &password);
+
+    QString name() const override { return "Firebird"; }
+    bool open(const QString &path) override;
+
+protected:
+    QString limitClause(int limit) const override { return QString("ROWS %1").arg(limit); }
+
+private:
+    QString m_user, m_password;
+};
+
+#endif // FIREBIRDBACKEND_H
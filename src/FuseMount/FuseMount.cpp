@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "FuseMount.h"
+#include "Tracer/Tracer.h"
+#include <QFile>
+#include <QSet>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+FuseMount::FuseMount(SqlCore *sqlCore, TreeItem *root) :
+    m_sqlCore(sqlCore)
+{
+    addFolder("/", root);
+}
+
+void FuseMount::addFolder(const QByteArray &path, TreeItem *folder)
+{
+    Node &node = m_nodes[path];
+    node.item = folder;
+
+    const QByteArray prefix = path.endsWith('/') ? path : path + '/';
+    QSet<QByteArray> used;
+
+    for (int i = 0; i < folder->childCount(); i++) {
+        TreeItem *child = folder->childItem(i);
+
+        // Slash can't be a part of file name, names must be unique in a directory
+        QByteArray name = child->name().toUtf8().replace('/', '_');
+        if (name.isEmpty() || (name == ".") || (name == ".."))
+            name = QByteArray::number(child->id(), 16).rightJustified(8, '0');
+        if (used.contains(name))
+            name += "~" + QByteArray::number(child->id(), 16).rightJustified(8, '0');
+        used.insert(name);
+
+        node.names.append(name);
+
+        if (child->isFoler())
+            addFolder(prefix + name, child);
+        else
+            m_nodes.insert(prefix + name, { child, QList<QByteArray>() });
+    }
+}
+
+bool FuseMount::exec(const QString &mountPoint)
+{
+    fuse_operations operations = {};
+    operations.init = init;
+    operations.getattr = getattr;
+    operations.readdir = readdir;
+    operations.open = open;
+    operations.read = read;
+    operations.release = release;
+
+    // Root item name is shown by mount and df, commas would split the options
+    const QByteArray options = "ro,fsname=" + m_nodes.value("/").item->name().toUtf8().replace(',', '_')
+                               + ",subtype=acedb";
+
+    fuse_args args = FUSE_ARGS_INIT(0, nullptr);
+    fuse_opt_add_arg(&args, "ace-database-viewer");
+    fuse_opt_add_arg(&args, "-o");
+    fuse_opt_add_arg(&args, options.constData());
+
+    fuse *fs = fuse_new(&args, &operations, sizeof(operations), this);
+    fuse_opt_free_args(&args);
+
+    if (!fs) {
+        m_lastErrorMsg = "FUSE initialization error!";
+        return false;
+    }
+
+    if (fuse_mount(fs, QFile::encodeName(mountPoint).constData()) != 0) {
+        m_lastErrorMsg = QString("Can't mount %1").arg(mountPoint);
+        fuse_destroy(fs);
+        return false;
+    }
+
+    // Ctrl+C unmounts the filesystem and returns from the loop
+    fuse_session *session = fuse_get_session(fs);
+    fuse_set_signal_handlers(session);
+    const int result = fuse_loop(fs);
+    fuse_remove_signal_handlers(session);
+
+    fuse_unmount(fs);
+    fuse_destroy(fs);
+
+    if (result != 0) {
+        m_lastErrorMsg = QString("FUSE loop error: %1").arg(strerror(-result));
+        return false;
+    }
+
+    return true;
+}
+
+FuseMount *FuseMount::instance()
+{
+    return static_cast<FuseMount*>(fuse_get_context()->private_data);
+}
+
+const FuseMount::Node *FuseMount::node(const char *path)
+{
+    const QHash<QByteArray, Node> &nodes = instance()->m_nodes;
+    const auto it = nodes.constFind(QByteArray::fromRawData(path, strlen(path)));
+    return (it != nodes.constEnd()) ? &it.value() : nullptr;
+}
+
+void *FuseMount::init(fuse_conn_info *conn, fuse_config *config)
+{
+    Q_UNUSED(conn);
+
+    // Content never changes, the kernel may keep it in page cache
+    config->kernel_cache = 1;
+    config->entry_timeout = 3600;
+    config->attr_timeout = 3600;
+
+    return instance();
+}
+
+int FuseMount::getattr(const char *path, struct stat *st, fuse_file_info *fi)
+{
+    Q_UNUSED(fi);
+
+    const Node *node = FuseMount::node(path);
+    if (!node)
+        return -ENOENT;
+
+    memset(st, 0, sizeof(struct stat));
+
+    TreeItem *item = node->item;
+    if (item->isFoler()) {
+        st->st_mode = S_IFDIR | 0555;
+        st->st_nlink = 2;
+    } else {
+        st->st_mode = S_IFREG | 0444;
+        st->st_nlink = 1;
+        st->st_size = item->size();
+        if (item->ctime().isValid())
+            st->st_mtime = item->ctime().toSecsSinceEpoch();
+    }
+
+    st->st_uid = getuid();
+    st->st_gid = getgid();
+
+    return 0;
+}
+
+int FuseMount::readdir(const char *path, void *buf, fuse_fill_dir_t filler,
+                       off_t offset, fuse_file_info *fi, fuse_readdir_flags flags)
+{
+    Q_UNUSED(offset);
+    Q_UNUSED(fi);
+    Q_UNUSED(flags);
+
+    const Node *node = FuseMount::node(path);
+    if (!node)
+        return -ENOENT;
+    if (!node->item->isFoler())
+        return -ENOTDIR;
+
+    filler(buf, ".", nullptr, 0, (fuse_fill_dir_flags)0);
+    filler(buf, "..", nullptr, 0, (fuse_fill_dir_flags)0);
+    for (const QByteArray &name : node->names)
+        filler(buf, name.constData(), nullptr, 0, (fuse_fill_dir_flags)0);
+
+    return 0;
+}
+
+int FuseMount::open(const char *path, fuse_file_info *fi)
+{
+    const Node *node = FuseMount::node(path);
+    if (!node)
+        return -ENOENT;
+    if (node->item->isFoler())
+        return -EISDIR;
+    if ((fi->flags & O_ACCMODE) != O_RDONLY)
+        return -EROFS;
+
+    TRACE_SCOPE("fuse open");
+
+    // Only compressed BLOB is read here, pages are inflated by read()
+    RecordDevice *device = instance()->m_sqlCore->dataDevice(node->item);
+    if (!device)
+        return -EIO;
+
+    if (!device->open(QIODevice::ReadOnly)) {
+        delete device;
+        return -EIO;
+    }
+
+    fi->fh = reinterpret_cast<quintptr>(device);
+    fi->keep_cache = 1;
+
+    return 0;
+}
+
+int FuseMount::read(const char *path, char *buf, size_t size, off_t offset, fuse_file_info *fi)
+{
+    Q_UNUSED(path);
+
+    TRACE_SCOPE("fuse read");
+
+    RecordDevice *device = reinterpret_cast<RecordDevice*>(fi->fh);
+    if (offset >= device->size())
+        return 0;
+
+    if (!device->seek(offset))
+        return -EIO;
+
+    const qint64 count = device->read(buf, size);
+    if (count < 0)
+        return -EIO;
+
+    Tracer::count("bytes read", count);
+    return (int)count;
+}
+
+int FuseMount::release(const char *path, fuse_file_info *fi)
+{
+    Q_UNUSED(path);
+
+    delete reinterpret_cast<RecordDevice*>(fi->fh);
+    return 0;
+}
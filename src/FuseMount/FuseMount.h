@@ -0,0 +1,56 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef FUSEMOUNT_H
+#define FUSEMOUNT_H
+
+#define FUSE_USE_VERSION 31
+
+#include <fuse.h>
+#include <QHash>
+#include "SqlCore/SqlCore.h"
+
+// Read-only FUSE filesystem over the database tree: folders are directories,
+// files are regular files. Nothing is inflated until a file is read, then
+// RecordDevice inflates only the pages requested and keeps them in
+// RecordCache. Requests are served by a single thread, the database
+// connection can't be used by other threads. Built with CONFIG+=fuse.
+class FuseMount
+{
+public:
+    FuseMount(SqlCore *sqlCore, TreeItem *root);
+
+    // Mounts the tree and serves requests until the filesystem is
+    // unmounted (fusermount3 -u) or the process is interrupted
+    bool exec(const QString &mountPoint);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+private:
+    struct Node {
+        TreeItem *item;
+        QList<QByteArray> names;    // Directory entries of a folder
+    };
+
+    SqlCore *m_sqlCore;
+    QHash<QByteArray, Node> m_nodes;    // Key is the path, "/" for the root
+    QString m_lastErrorMsg;
+
+    void addFolder(const QByteArray &path, TreeItem *folder);
+    static FuseMount *instance();
+    static const Node *node(const char *path);
+
+    static void *init(fuse_conn_info *conn, fuse_config *config);
+    static int getattr(const char *path, struct stat *st, fuse_file_info *fi);
+    static int readdir(const char *path, void *buf, fuse_fill_dir_t filler,
+                       off_t offset, fuse_file_info *fi, fuse_readdir_flags flags);
+    static int open(const char *path, fuse_file_info *fi);
+    static int read(const char *path, char *buf, size_t size, off_t offset, fuse_file_info *fi);
+    static int release(const char *path, fuse_file_info *fi);
+};
+
+#endif // FUSEMOUNT_H
@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "InflateContext.h"
+#include "Tracer/Tracer.h"
+#include <QtEndian>
+#include <climits>
+
+static const int CHUNK_SIZE = 0x10000;
+
+// Deflate can't compress better than 1032:1, a larger length prefix is damage
+static const qint64 MAX_RATIO = 1032;
+
+// Engine of thread local contexts, the generation is bumped on every change
+static QMutex localEngineMutex;
+static QString localEngine;
+static QAtomicInt localGeneration;
+
+InflateContext::InflateContext(const QString &engine)
+    : m_inflater(Inflater::create(engine)),
+    m_generation(0),
+    m_streamReady(false)
+{
+    if (!m_inflater)
+        m_inflater = Inflater::create();
+
+    memset(&m_stream, 0, sizeof(m_stream));
+}
+
+InflateContext::~InflateContext()
+{
+    if (m_streamReady)
+        inflateEnd(&m_stream);
+
+    delete m_inflater;
+}
+
+bool InflateContext::setEngine(const QString &name)
+{
+    Inflater *inflater = Inflater::create(name);
+
+    if (!inflater)
+        return false;
+
+    delete m_inflater;
+    m_inflater = inflater;
+
+    return true;
+}
+
+bool InflateContext::inflateBlob(const QByteArray &blob, QByteArray *out)
+{
+    TRACE_SCOPE("inflate");
+
+    if (blob.size() < (int)sizeof(quint32)) {
+        out->resize(0);
+        return false;
+    }
+
+    const quint32 length = qFromLittleEndian<quint32>(blob.constData());
+    const qint64 packed = blob.size() - (qint64)sizeof(quint32);
+
+    // Damaged prefix must not turn into a huge or negative allocation
+    if ((length > (quint32)INT_MAX) || (length > packed * MAX_RATIO)) {
+        out->resize(0);
+        return false;
+    }
+
+    // Buffer still shared with a previous user is not copied, just replaced
+    if (!out->isDetached())
+        *out = QByteArray();
+
+    // Reserved capacity is never released by resize(), so the buffer
+    // is reallocated only for a record larger than all previous ones
+    out->reserve(qMax<int>(out->capacity(), (int)length));
+    out->resize((int)length);
+
+    const qint64 written = m_inflater->inflate(blob.constData() + sizeof(quint32),
+                                               packed,
+                                               out->data(),
+                                               out->size());
+
+    out->resize(qMax<qint64>(written, 0));
+    Tracer::count("bytes inflated", out->size());
+
+    return written >= 0;
+}
+
+qint64 InflateContext::streamBlob(const QByteArray &blob,
+                                  const std::function<void(const char *data, int size)> &sink,
+                                  QString *errorMsg)
+{
+    TRACE_SCOPE("inflate stream");
+
+    if (blob.size() < (int)sizeof(quint32)) {
+        if (errorMsg)
+            *errorMsg = "no data";
+        return -1;
+    }
+
+    // The stream is initialized once and reset for every next record
+    int err = m_streamReady ? inflateReset(&m_stream) : inflateInit(&m_stream);
+    m_streamReady = (err == Z_OK);
+
+    if (!m_streamReady) {
+        if (errorMsg)
+            *errorMsg = "inflate init error";
+        return -1;
+    }
+
+    if (m_chunk.isEmpty())
+        m_chunk.resize(CHUNK_SIZE);
+
+    m_stream.next_in = (Bytef *)blob.constData() + sizeof(quint32);
+    m_stream.avail_in = blob.size() - sizeof(quint32);
+
+    qint64 total = 0;
+
+    while (err == Z_OK) {
+        m_stream.next_out = (Bytef *)m_chunk.data();
+        m_stream.avail_out = m_chunk.size();
+        err = inflate(&m_stream, Z_NO_FLUSH);
+
+        const int size = m_chunk.size() - m_stream.avail_out;
+        if (size && sink)
+            sink(m_chunk.constData(), size);
+        total += size;
+    }
+
+    Tracer::count("bytes inflated", total);
+
+    if (err == Z_STREAM_END)
+        return total;
+
+    if (errorMsg) {
+        if (err == Z_BUF_ERROR)
+            *errorMsg = "zlib stream is truncated";
+        else
+            *errorMsg = QString("zlib error: %1").arg(m_stream.msg ? m_stream.msg : "unknown");
+    }
+
+    return -1;
+}
+
+InflateContext *InflateContext::local()
+{
+    // Contexts are deleted when their threads finish
+    static QThreadStorage<InflateContext*> contexts;
+
+    if (!contexts.hasLocalData())
+        contexts.setLocalData(new InflateContext);
+
+    InflateContext *context = contexts.localData();
+
+    const int generation = localGeneration.loadAcquire();
+    if (context->m_generation != generation) {
+        QMutexLocker locker(&localEngineMutex);
+        context->setEngine(localEngine);
+        context->m_generation = generation;
+    }
+
+    return context;
+}
+
+bool InflateContext::setLocalEngine(const QString &name)
+{
+    QScopedPointer<Inflater> inflater(Inflater::create(name));
+
+    if (!inflater)
+        return false;
+
+    QMutexLocker locker(&localEngineMutex);
+    if (localEngine != inflater->name()) {
+        localEngine = inflater->name();
+        localGeneration.fetchAndAddRelease(1);
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef INFLATECONTEXT_H
+#define INFLATECONTEXT_H
+
+#include <QtCore>
+#include <QtZlib/zlib.h>
+#include <functional>
+#include "Inflater/Inflater.h"
+
+// Decompression state of one thread: inflate engine, streaming z_stream and
+// chunk buffer are set up once and reused, so decompression of a record makes
+// no allocations when the output buffer is large enough already.
+class InflateContext
+{
+public:
+    explicit InflateContext(const QString &engine = QString());
+    ~InflateContext();
+
+    // Returns false for unknown engine, see Inflater::engines()
+    bool setEngine(const QString &name);
+    QString engine() const { return m_inflater->name(); }
+
+    // Inflates DATA BLOB (32-bit length prefix + zlib stream) in one go.
+    // Output buffer keeps its capacity between calls, its content
+    // is not initialized before inflating.
+    bool inflateBlob(const QByteArray &blob, QByteArray *out);
+
+    // Inflates DATA BLOB chunk by chunk, memory use doesn't depend on record
+    // size. Returns number of inflated bytes or -1 on error.
+    qint64 streamBlob(const QByteArray &blob,
+                      const std::function<void(const char *data, int size)> &sink,
+                      QString *errorMsg = nullptr);
+
+    // Context of the current thread, for thread pool jobs
+    static InflateContext *local();
+    // Engine of the contexts returned by local(), contexts created before
+    // switch to it on their next use. Returns false for unknown engine.
+    static bool setLocalEngine(const QString &name);
+
+private:
+    Inflater *m_inflater;
+    int m_generation;   // Of the local engine this context uses
+    z_stream m_stream;
+    bool m_streamReady;
+    QByteArray m_chunk;
+};
+
+#endif // INFLATECONTEXT_H
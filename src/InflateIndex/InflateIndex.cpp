@@ -0,0 +1,37 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "InflateIndex.h"
+#include <algorithm>
+
+const InflateIndex::Point *InflateIndex::find(qint64 offset) const
+{
+    auto it = std::upper_bound(m_points.cbegin(), m_points.cend(), offset,
+                               [](qint64 value, const Point &point) { return value < point.out; });
+
+    if (it == m_points.cbegin())
+        return nullptr;
+
+    return &*(it - 1);
+}
+
+bool InflateIndex::needPoint(qint64 out) const
+{
+    const qint64 last = m_points.isEmpty() ? 0 : m_points.last().out;
+    return out - last >= SPAN;
+}
+
+void InflateIndex::append(const Point &point)
+{
+    m_points.append(point);
+}
+
+int InflateIndex::cost(qint64 recordSize)
+{
+    return qMax<qint64>(1, recordSize / SPAN * WINDOW_SIZE / 1024);
+}
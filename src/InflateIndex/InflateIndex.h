@@ -0,0 +1,47 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef INFLATEINDEX_H
+#define INFLATEINDEX_H
+
+#include <QtCore>
+
+// Random access checkpoints of a deflate stream (see zran.c from zlib examples).
+// Every checkpoint keeps inflate state at a deflate block boundary: position
+// in both streams, bit offset and the last 32 KiB of uncompressed data.
+class InflateIndex
+{
+public:
+    enum {
+        SPAN = 0x100000,            // Distance between checkpoints, 1 MiB of uncompressed data
+        WINDOW_SIZE = 0x8000,       // Deflate window size
+        MIN_RECORD_SIZE = 0x400000  // Smaller records are not worth indexing
+    };
+
+    struct Point {
+        qint64 out;         // Uncompressed offset
+        qint64 in;          // Compressed offset of the first byte after the checkpoint
+        int bits;           // Number of bits of the previous byte to use, 0..7
+        QByteArray window;  // Uncompressed data preceding the checkpoint
+    };
+
+    // Checkpoint nearest to the offset from below, nullptr if there is none
+    const Point *find(qint64 offset) const;
+    // True if the offset is at least SPAN after the last checkpoint
+    bool needPoint(qint64 out) const;
+    void append(const Point &point);
+
+    int count() const { return m_points.count(); }
+    // Memory cost in KiB for the worst case, when the whole record is indexed
+    static int cost(qint64 recordSize);
+
+private:
+    QVector<Point> m_points;
+};
+
+#endif // INFLATEINDEX_H
@@ -0,0 +1,38 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Inflater.h"
+#include "ZlibInflater/ZlibInflater.h"
+#ifdef USE_LIBDEFLATE
+#include "LibdeflateInflater/LibdeflateInflater.h"
+#endif
+
+QStringList Inflater::engines()
+{
+    QStringList list;
+#ifdef USE_LIBDEFLATE
+    list << "libdeflate";
+#endif
+    list << "zlib";
+    return list;
+}
+
+Inflater *Inflater::create(const QString &name)
+{
+    const QString engine = name.isEmpty() ? engines().first() : name.toLower();
+
+#ifdef USE_LIBDEFLATE
+    if (engine == "libdeflate")
+        return new LibdeflateInflater;
+#endif
+
+    if (engine == "zlib")
+        return new ZlibInflater;
+
+    return nullptr;
+}
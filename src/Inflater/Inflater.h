@@ -0,0 +1,34 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <QtCore>
+
+// One-shot decoder of complete zlib streams. Implementations are not
+// thread-safe, every thread needs its own instance.
+class Inflater
+{
+public:
+    virtual ~Inflater() {}
+
+    virtual QString name() const = 0;
+
+    // Inflates zlib stream into the buffer of known uncompressed size,
+    // returns number of bytes written or -1 on error
+    virtual qint64 inflate(const char *in, qint64 inSize, char *out, qint64 outSize) = 0;
+
+    // Engines compiled in, the fastest one first
+    static QStringList engines();
+    // Creates engine by name, the fastest one for empty name,
+    // nullptr for unknown name
+    static Inflater *create(const QString &name = QString());
+};
+
+#endif // INFLATER_H
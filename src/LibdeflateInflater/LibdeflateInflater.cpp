@@ -0,0 +1,36 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "LibdeflateInflater.h"
+#include <libdeflate.h>
+
+LibdeflateInflater::LibdeflateInflater()
+    : m_decompressor(libdeflate_alloc_decompressor())
+{
+
+}
+
+LibdeflateInflater::~LibdeflateInflater()
+{
+    libdeflate_free_decompressor(m_decompressor);
+}
+
+qint64 LibdeflateInflater::inflate(const char *in, qint64 inSize, char *out, qint64 outSize)
+{
+    if (!m_decompressor)
+        return -1;
+
+    size_t length = 0;
+
+    libdeflate_result result = libdeflate_zlib_decompress(m_decompressor, in, inSize, out, outSize, &length);
+
+    if (result != LIBDEFLATE_SUCCESS)
+        return -1;
+
+    return length;
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef LIBDEFLATEINFLATER_H
+#define LIBDEFLATEINFLATER_H
+
+#include "Inflater/Inflater.h"
+
+struct libdeflate_decompressor;
+
+// libdeflate decoder, several times faster than zlib on x86-64 and ARM64.
+// Built with "qmake CONFIG+=libdeflate" only.
+class LibdeflateInflater : public Inflater
+{
+public:
+    LibdeflateInflater();
+    ~LibdeflateInflater();
+
+    QString name() const override { return "libdeflate"; }
+    qint64 inflate(const char *in, qint64 inSize, char *out, qint64 outSize) override;
+
+private:
+    libdeflate_decompressor *m_decompressor;
+};
+
+#endif // LIBDEFLATEINFLATER_H
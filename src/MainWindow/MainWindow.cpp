@@ -13,13 +13,23 @@
 #include <QStandardPaths>
 #include <QDragEnterEvent>
 #include <QMimeData>
+#include <QProgressDialog>
 #include <QDebug>
-#include "DataViewDialog/DataViewDialog.h"
+#include "Exporter/Exporter.h"
+#include "ExportFilterDialog/ExportFilterDialog.h"
+#include "SqliteConverter/SqliteConverter.h"
+#include "Repacker/Repacker.h"
+#include "DbDiff/DbDiff.h"
+#include "DiffDialog/DiffDialog.h"
+#include "RecordDiffDialog/RecordDiffDialog.h"
+#include "ProfileGridDialog/ProfileGridDialog.h"
+#include "Verifier/Verifier.h"
+#include "BatchPipeline/BatchPipeline.h"
+#include "Tracer/Tracer.h"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow),
-    m_rootItem(nullptr) // Important! No data loaded yet.
+    ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
 
@@ -27,7 +37,16 @@ MainWindow::MainWindow(QWidget *parent) :
 
     // File menu actions
     connect(ui->actionOpenFile, &QAction::triggered, this, &MainWindow::openFile);
+    connect(ui->actionClose, &QAction::triggered, this, &MainWindow::closeDatabase);
     connect(ui->actionExportAll, &QAction::triggered, this, &MainWindow::exportAll);
+    connect(ui->actionExportFiltered, &QAction::triggered, this, &MainWindow::exportFiltered);
+    connect(ui->actionConvertToSqlite, &QAction::triggered, this, &MainWindow::convertToSqlite);
+    connect(ui->actionRepack, &QAction::triggered, this, &MainWindow::repack);
+    connect(ui->actionCompare, &QAction::triggered, this, &MainWindow::compareWith);
+    connect(ui->actionCompareRecords, &QAction::triggered, this, &MainWindow::compareRecords);
+    connect(ui->actionProfileGrid, &QAction::triggered, this, &MainWindow::profileGrid);
+    connect(ui->actionVerify, &QAction::triggered, this, &MainWindow::verify);
+    connect(ui->actionTrace, &QAction::toggled, this, &MainWindow::trace);
     connect(ui->actionExit, &QAction::triggered, this, &MainWindow::close);
 
     // Help menu actions
@@ -39,13 +58,18 @@ MainWindow::MainWindow(QWidget *parent) :
     // Allow drag & drop events
     setAcceptDrops(true);
 
-    // SQL core object
-    m_sqlCore = new SqlCore(this);
-
     // Tree model object
     m_treeModel = new TreeModel(this);
     ui->treeView->setModel(m_treeModel);
 
+    // Open databases, each one is a top level item of the tree
+    m_workspace = new Workspace(m_treeModel, this);
+    connect(m_workspace, &Workspace::opened, this, &MainWindow::opened);
+    connect(m_workspace, &Workspace::failed, this, &MainWindow::failed);
+
+    // Statistics of the current database
+    connect(ui->treeView->selectionModel(), &QItemSelectionModel::currentChanged, this, &MainWindow::updateInfoLabel);
+
     // Resize first column for better view
     ui->treeView->header()->resizeSection(0, width() / 2);
 
@@ -55,8 +79,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
-    if (m_rootItem)
-        delete m_rootItem;
+    // Tree items are deleted while the model still exists
+    delete m_workspace;
 
     delete ui;
 }
@@ -67,14 +91,60 @@ void MainWindow::openFile()
     const QString path = QFileDialog::getOpenFileName(this,
                                                       "Open file",
                                                       docs.first(),
-                                                      "Supported files (*.fdb *.pcr);;All files (*.*)");
+                                                      "Supported files (*.fdb *.pcr *.sqlite);;All files (*.*)");
     if (!path.isEmpty())
         open(path);
 }
 
+void MainWindow::closeDatabase()
+{
+    TreeItem *databaseItem = currentDatabase();
+
+    if (databaseItem) {
+        // Viewers may wait for the records of the database
+        const QList<QPointer<DataViewDialog>> viewers = m_viewers.values(databaseItem);
+        for (const QPointer<DataViewDialog> &viewer : viewers)
+            delete viewer;
+        m_viewers.remove(databaseItem);
+
+        m_workspace->close(databaseItem);
+    }
+
+    updateInfoLabel();
+}
+
+TreeItem *MainWindow::currentDatabase()
+{
+    const QModelIndex index = ui->treeView->currentIndex();
+
+    if (index.isValid())
+        return m_workspace->databaseItem(static_cast<TreeItem*>(index.internalPointer()));
+
+    const QModelIndex first = m_treeModel->index(0, 0, QModelIndex());
+    return first.isValid() ? static_cast<TreeItem*>(first.internalPointer()) : nullptr;
+}
+
+bool MainWindow::fetchAll(TreeItem *item)
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool ok = m_treeModel->fetchAll(item);
+    QApplication::restoreOverrideCursor();
+    updateInfoLabel();
+
+    if (!ok)
+        QMessageBox::critical(this,
+                              "Error",
+                              "Files loading error!\n" + m_workspace->sqlCore(item)->lastErrorMsg());
+
+    return ok;
+}
+
 void MainWindow::exportAll()
 {
-    if (!m_rootItem || (m_sqlCore->fileCount() == 0)) {
+    TreeItem *databaseItem = currentDatabase();
+    SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+
+    if (!sqlCore || (sqlCore->fileCount() == 0)) {
         QMessageBox::information(this, "Export all", "There are no files to export.");
         return;
     }
@@ -86,16 +156,402 @@ void MainWindow::exportAll()
     if (path.isEmpty())
         return;
 
-    bool ok = true;
-    exportTreeItems(QDir(path), m_rootItem, &ok);
+    // Database is exported into the folder named as the database
+    QDir dir(path);
+    if (!dir.mkdir(databaseItem->name()) || !dir.cd(databaseItem->name())) {
+        QMessageBox::warning(this, "Warning", "Folder creation error!");
+        return;
+    }
+
+    if (!fetchAll(databaseItem))
+        return;
+
+    Exporter exporter(sqlCore);
+    if (exporter.exportItems(dir, databaseItem))
+        QMessageBox::information(this,
+                                 "Information",
+                                 QString("Completed successfully.\nPadding: %1")
+                                     .arg(Exporter::fillToText(exporter.fillStats())));
+    else
+        QMessageBox::warning(this,
+                             "Warning",
+                             "Completed with errors!");
+}
+
+void MainWindow::exportFiltered()
+{
+    // Selected folder, or folder of the selected file
+    const QModelIndex index = ui->treeView->currentIndex();
+    TreeItem *folder = index.isValid() ? static_cast<TreeItem*>(index.internalPointer()) : currentDatabase();
+    if (folder && !folder->isFoler())
+        folder = folder->parentItem();
+
+    SqlCore *sqlCore = m_workspace->sqlCore(folder);
+
+    if (!sqlCore || (sqlCore->fileCount() == 0)) {
+        QMessageBox::information(this, "Export filtered", "There are no files to export.");
+        return;
+    }
+
+    ExportFilterDialog dialog(folder->name(), this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const QStringList docs = QStandardPaths::standardLocations(QStandardPaths::DocumentsLocation);
+    const QString path = QFileDialog::getExistingDirectory(this,
+                                                           "Export filtered",
+                                                           docs.first());
+    if (path.isEmpty())
+        return;
+
+    if (!fetchAll(folder))
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    Exporter exporter(sqlCore);
+    const bool ok = exporter.exportFiltered(QDir(path), folder, dialog.filter());
+    QApplication::restoreOverrideCursor();
+
     if (ok)
+        QMessageBox::information(this,
+                                 "Information",
+                                 QString("%1 files exported.").arg(exporter.exportedCount()));
+    else
+        QMessageBox::warning(this,
+                             "Warning",
+                             QString("%1 files exported.\n%2").arg(exporter.exportedCount()).arg(exporter.lastErrorMsg()));
+}
+
+void MainWindow::convertToSqlite()
+{
+    TreeItem *databaseItem = currentDatabase();
+    SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+
+    if (!sqlCore || (sqlCore->fileCount() == 0)) {
+        QMessageBox::information(this, "Convert to SQLite", "There are no files to convert.");
+        return;
+    }
+
+    QFileInfo info(m_workspace->path(databaseItem));
+    const QString path = QFileDialog::getSaveFileName(this,
+                                                      "Convert to SQLite",
+                                                      info.absolutePath() + QDir::separator() + info.completeBaseName() + ".sqlite",
+                                                      "SQLite files (*.sqlite);;All files (*.*)");
+    if (path.isEmpty())
+        return;
+
+    QProgressDialog progress("Converting...", "Cancel", 0, sqlCore->fileCount(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    SqliteConverter converter(sqlCore->backend());
+    connect(&converter, &SqliteConverter::progress, this, [&](int count) {
+        progress.setValue(count);
+        if (progress.wasCanceled())
+            converter.cancel();
+    });
+
+    if (converter.convert(path)) {
+        progress.reset();
         QMessageBox::information(this,
                                  "Information",
                                  "Completed successfully.");
+    } else {
+        progress.reset();
+        QMessageBox::warning(this,
+                             "Warning",
+                             converter.lastErrorMsg());
+    }
+}
+
+void MainWindow::repack()
+{
+    // Folders and files selected with Ctrl+click, all of the same database
+    TreeItem *databaseItem = currentDatabase();
+    SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+
+    QList<TreeItem*> items;
+    const QModelIndexList selected = ui->treeView->selectionModel()->selectedRows();
+    for (const QModelIndex &index : selected) {
+        TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+        if (m_workspace->databaseItem(item) == databaseItem)
+            items.append(item);
+    }
+
+    if (!sqlCore || items.isEmpty()) {
+        QMessageBox::information(this, "Repack", "Select folders and files to repack.");
+        return;
+    }
+
+    QFileInfo info(m_workspace->path(databaseItem));
+    const QString path = QFileDialog::getSaveFileName(this,
+                                                      "Repack",
+                                                      info.absolutePath() + QDir::separator() + info.completeBaseName() + "-subset.pcr",
+                                                      "PC-3000 databases (*.pcr);;SQLite files (*.sqlite);;All files (*.*)");
+    if (path.isEmpty())
+        return;
+
+    QProgressDialog progress("Repacking...", "Cancel", 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    Repacker repacker(sqlCore);
+    connect(&repacker, &Repacker::progress, this, [&](int done, int total) {
+        progress.setMaximum(total);
+        progress.setValue(done);
+        if (progress.wasCanceled())
+            repacker.cancel();
+    });
+
+    const bool ok = repacker.repack(path, items);
+    progress.reset();
+
+    if (ok)
+        QMessageBox::information(this,
+                                 "Information",
+                                 QString("%1 files written, %2 recompressed.\nData: %3 -> %4 bytes.")
+                                     .arg(repacker.writtenCount())
+                                     .arg(repacker.repackedCount())
+                                     .arg(repacker.inputBytes())
+                                     .arg(repacker.outputBytes()));
     else
         QMessageBox::warning(this,
                              "Warning",
-                             "Completed with errors!");
+                             repacker.lastErrorMsg());
+}
+
+void MainWindow::compareWith()
+{
+    TreeItem *databaseItem = currentDatabase();
+    SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+
+    if (!sqlCore) {
+        QMessageBox::information(this, "Compare", "Open a database to compare with first.");
+        return;
+    }
+
+    QFileInfo info(m_workspace->path(databaseItem));
+    const QString path = QFileDialog::getOpenFileName(this,
+                                                      "Compare with",
+                                                      info.absolutePath(),
+                                                      "Supported files (*.fdb *.pcr *.sqlite);;All files (*.*)");
+    if (path.isEmpty())
+        return;
+
+    const bool fullContent = QMessageBox::question(this,
+                                                   "Compare",
+                                                   "Compare content of all files?\n"
+                                                   "Otherwise only files with changed time are compared by content.")
+                             == QMessageBox::Yes;
+
+    // Database open in the workspace is used as is, other one is loaded for comparison only
+    SqlCore newCore;
+    newCore.copySettings(sqlCore);
+    newCore.setPageSize(0);
+    TreeItem newRoot(0, QFileInfo(path).completeBaseName(), nullptr);
+    TreeItem *newItem = m_workspace->find(path);
+    SqlCore *newSqlCore = m_workspace->sqlCore(newItem);
+
+    if (!newItem) {
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        const bool loaded = newCore.load(path, &newRoot);
+        QApplication::restoreOverrideCursor();
+
+        if (!loaded) {
+            QMessageBox::critical(this, "Error!", newCore.lastErrorMsg());
+            return;
+        }
+
+        newItem = &newRoot;
+        newSqlCore = &newCore;
+    } else if (!fetchAll(newItem))
+        return;
+
+    if (!fetchAll(databaseItem))
+        return;
+
+    QProgressDialog progress("Comparing...", "Cancel", 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    DbDiff dbDiff(sqlCore, newSqlCore);
+    connect(&dbDiff, &DbDiff::progress, this, [&](int done, int total) {
+        progress.setMaximum(total);
+        progress.setValue(done);
+        if (progress.wasCanceled())
+            dbDiff.cancel();
+    });
+
+    // Old tree is the current database of the main window
+    const bool ok = dbDiff.compare(databaseItem, newItem, fullContent);
+    progress.reset();
+
+    if (!ok) {
+        QMessageBox::warning(this, "Warning", dbDiff.lastErrorMsg());
+        return;
+    }
+
+    DiffDialog dialog(databaseItem->name(), newItem->name(), dbDiff, this);
+    dialog.exec();
+}
+
+void MainWindow::compareRecords()
+{
+    // Two files selected with Ctrl+click, they may belong to different databases
+    QVector<TreeItem*> items;
+    const QModelIndexList selected = ui->treeView->selectionModel()->selectedRows();
+    for (const QModelIndex &index : selected) {
+        TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+        if (!item->isFoler())
+            items.append(item);
+    }
+
+    if (items.count() != 2) {
+        QMessageBox::information(this, "Compare two files", "Select two files to compare (Ctrl+click).");
+        return;
+    }
+
+    QByteArray data[2];
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = true;
+    for (int i = 0; i < 2; i++)
+        if (!m_workspace->sqlCore(items.at(i))->rawData(items.at(i), &data[i]))
+            ok = false;
+    QApplication::restoreOverrideCursor();
+
+    if (!ok) {
+        QMessageBox::critical(this, "Error", "Data reading error!");
+        return;
+    }
+
+    RecordDiffDialog dialog(items.at(0)->name(), data[0], items.at(1)->name(), data[1], this);
+    dialog.exec();
+}
+
+void MainWindow::profileGrid()
+{
+    // Selected folder, or folder of the selected file
+    const QModelIndex index = ui->treeView->currentIndex();
+    TreeItem *folder = index.isValid() ? static_cast<TreeItem*>(index.internalPointer()) : currentDatabase();
+    if (folder && !folder->isFoler())
+        folder = folder->parentItem();
+
+    RecordLoader *loader = m_workspace->recordLoader(folder);
+    if (!loader)
+        return;
+
+    if (!fetchAll(folder))
+        return;
+
+    // Files of the whole subtree in tree order
+    QVector<QPair<TreeItem*, QString>> files;
+    BatchPipeline::collectFiles(folder, QString(), &files);
+
+    QVector<TreeItem*> items;
+    for (const auto &file : qAsConst(files))
+        items.append(file.first);
+
+    if (items.isEmpty()) {
+        QMessageBox::information(this, "Profiles of folder", "There are no files in the folder.");
+        return;
+    }
+
+    ProfileGridDialog dialog(folder->name(), loader, items, this);
+    dialog.exec();
+}
+
+void MainWindow::verify()
+{
+    TreeItem *databaseItem = currentDatabase();
+    SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+
+    if (!sqlCore || (sqlCore->fileCount() == 0)) {
+        QMessageBox::information(this, "Verify", "There are no files to verify.");
+        return;
+    }
+
+    if (!fetchAll(databaseItem))
+        return;
+
+    QProgressDialog progress("Verifying...", "Cancel", 0, sqlCore->fileCount(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    Verifier verifier(sqlCore);
+    connect(&verifier, &Verifier::progress, this, [&](int done, int total) {
+        progress.setMaximum(total);
+        progress.setValue(done);
+        if (progress.wasCanceled())
+            verifier.cancel();
+    });
+
+    const bool ok = verifier.verify(databaseItem);
+    progress.reset();
+
+    if (!ok) {
+        QMessageBox::warning(this, "Warning", verifier.lastErrorMsg());
+        return;
+    }
+
+    if (verifier.problems().isEmpty()) {
+        QMessageBox::information(this,
+                                 "Information",
+                                 QString("No problems found in %1 files.").arg(verifier.checkedCount()));
+        return;
+    }
+
+    // Full report goes to "Show Details..." area
+    QStringList report;
+    for (const Verifier::Problem &problem : verifier.problems())
+        report.append(problem.path + ": " + problem.message);
+
+    QMessageBox box(QMessageBox::Warning,
+                    "Warning",
+                    QString("%1 of %2 files are corrupt.")
+                        .arg(verifier.problems().count())
+                        .arg(verifier.checkedCount()),
+                    QMessageBox::Ok,
+                    this);
+    box.setDetailedText(report.join(QChar::LineFeed));
+    box.exec();
+}
+
+void MainWindow::startTrace(const QString &path)
+{
+    Tracer::start(path);
+
+    QSignalBlocker blocker(ui->actionTrace);
+    ui->actionTrace->setChecked(true);
+}
+
+void MainWindow::trace(bool enabled)
+{
+    if (enabled) {
+        QString path = QFileDialog::getSaveFileName(this,
+                                                    "Trace to file",
+                                                    QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+                                                    "Chrome trace (*.json)");
+        if (path.isEmpty()) {
+            QSignalBlocker blocker(ui->actionTrace);
+            ui->actionTrace->setChecked(false);
+            return;
+        }
+
+        Tracer::start(path);
+        return;
+    }
+
+    // Time per phase in "Show Details..." area, full trace is in the file
+    QString errorMsg;
+    const QString summary = Tracer::finish(&errorMsg);
+
+    QMessageBox box(errorMsg.isEmpty() ? QMessageBox::Information : QMessageBox::Warning,
+                    errorMsg.isEmpty() ? "Information" : "Warning",
+                    errorMsg.isEmpty() ? "Trace file has been written." : errorMsg,
+                    QMessageBox::Ok,
+                    this);
+    box.setDetailedText(summary);
+    box.exec();
 }
 
 void MainWindow::about()
@@ -115,125 +571,173 @@ void MainWindow::dataView(const QModelIndex &index)
     if (item->isFoler())
         return;
 
-    QByteArray rawData = m_sqlCore->rawData(item);
-    QByteArray rawProfile = m_sqlCore->rawProfile(item);
+    Tracer::count("records viewed");
 
-    if (item->size() != rawData.size())
-        QMessageBox::warning(this,
-                             "Warning",
-                             QString("Wrong data size detected!\nReceived: %1 bytes, expected: %2 bytes.")
-                                 .arg(rawData.size())
-                                 .arg(item->size()));
-
-    DataViewDialog dialog(item->name(), // Window title
-                          item->type() == TreeItem::Text, // View as hex dump or plain text
-                          rawData,
-                          rawProfile,
-                          this);
-    dialog.exec();
+    // Dialog is shown at once, BLOBs are loaded in background by the loader
+    // of the database, data is inflated on demand while viewing
+    TreeItem *databaseItem = m_workspace->databaseItem(item);
+    SqlCore *sqlCore = m_workspace->sqlCore(item);
+    RecordLoader *loader = m_workspace->recordLoader(item);
+
+    if (!loader)
+        return;
+
+    DataViewDialog *dialog = new DataViewDialog(item->name(), // Window title
+                                                item->type() == TreeItem::Text, // View as hex dump or plain text
+                                                this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    // Forget viewers closed by user
+    for (auto it = m_viewers.begin(); it != m_viewers.end(); )
+        it = it.value().isNull() ? m_viewers.erase(it) : std::next(it);
+    m_viewers.insert(databaseItem, dialog);
+
+    const int ticket = loader->request(item->id());
+
+    connect(loader, &RecordLoader::loaded, dialog,
+            [dialog, sqlCore, item, ticket](int loadedTicket, const QByteArray &data,
+                                            const QByteArray &profile, const QString &errorMsg) {
+        if (loadedTicket != ticket)
+            return;
+
+        RecordDevice *dataDevice = data.isEmpty() ? nullptr : sqlCore->dataDevice(item, data);
+
+        if (!dataDevice) {
+            dialog->setError(errorMsg.isEmpty() ? "Data reading error!" : "Data reading error!\n" + errorMsg);
+            return;
+        }
+
+        const qint64 size = dataDevice->size();
+        dialog->setData(dataDevice, profile);
+
+        // Length prefix against DATASIZE, the stream itself is checked
+        // when it is read, see RecordDevice::readFailed()
+        if (item->size() != size)
+            dialog->showMessage(QString("Wrong data size detected! Length prefix: %1 bytes, expected: %2 bytes.")
+                                    .arg(size)
+                                    .arg(item->size()));
+    });
+
+    // Record closed before it is loaded
+    connect(dialog, &QObject::destroyed, loader, [loader, ticket]() {
+        loader->cancel(ticket);
+    });
+
+    dialog->show();
 }
 
 void MainWindow::dragEnterEvent(QDragEnterEvent *event)
 {
     if (event->mimeData()->hasFormat("text/uri-list")) {
         const QList<QUrl> list = event->mimeData()->urls();
-        if (list.count() == 1) {
-            const QString name = list.first().toLocalFile();
-            if (name.endsWith(".fdb", Qt::CaseInsensitive)
-                || name.endsWith(".pcr", Qt::CaseInsensitive))
+        for (const QUrl &url : list)
+            if (isSupportedFile(url.toLocalFile())) {
                 event->acceptProposedAction();
-        }
+                return;
+            }
     }
 }
 
 void MainWindow::dropEvent(QDropEvent *event)
 {
     const QList<QUrl> list = event->mimeData()->urls();
-    if (list.count() == 1) {
-        const QString name = list.first().toLocalFile();
-        if (name.endsWith(".fdb", Qt::CaseInsensitive)
-            || name.endsWith(".pcr", Qt::CaseInsensitive))
+    for (const QUrl &url : list) {
+        const QString name = url.toLocalFile();
+        if (isSupportedFile(name))
             open(name);
     }
 }
 
-void MainWindow::open(const QString &path)
+bool MainWindow::isSupportedFile(const QString &name)
 {
-    if (m_rootItem) {
-        m_treeModel->setRootItem(nullptr);
-        delete m_rootItem;
-        m_rootItem = nullptr;
-    }
+    return name.endsWith(".fdb", Qt::CaseInsensitive)
+           || name.endsWith(".pcr", Qt::CaseInsensitive)
+           || name.endsWith(".sqlite", Qt::CaseInsensitive);
+}
 
-    if (!m_sqlCore->open(path)) {
-        updateInfoLabel();
-        QMessageBox::critical(this, "Error!", m_sqlCore->lastErrorMsg());
-        return;
-    }
+void MainWindow::setCredentials(const QString &user, const QString &password)
+{
+    m_workspace->setCredentials(user, password);
+}
 
-    // New root item (hidden in TreeView)
-    m_rootItem = new TreeItem(-1, "ROOT", nullptr);
+void MainWindow::setEngine(SqlCore::Engine engine)
+{
+    m_workspace->setEngine(engine);
+}
 
-    // First child item will be named as file name
-    QFileInfo info(path);
-    TreeItem *dbNameItem = new TreeItem(0, info.completeBaseName(), m_rootItem);
-    m_rootItem->append(dbNameItem);
+void MainWindow::setInflateEngine(const QString &name)
+{
+    if (!m_workspace->setInflateEngine(name))
+        QMessageBox::warning(this,
+                             "Warning",
+                             QString("Unknown decompression engine %1, %2 is used.")
+                                 .arg(name)
+                                 .arg(m_workspace->inflateEngine()));
+}
 
-    // Database tree enumeration
-    m_sqlCore->enumerate(dbNameItem);
+void MainWindow::open(const QString &path)
+{
+    // Tree appears when the catalog is loaded
+    if (!m_workspace->open(path))
+        QMessageBox::information(this, "Information", QString("%1 is already open.").arg(QFileInfo(path).fileName()));
 
-    m_treeModel->setRootItem(m_rootItem);
-    QModelIndex rootIndex = m_treeModel->index(0, 0, QModelIndex());
-    ui->treeView->setCurrentIndex(rootIndex);
-    ui->treeView->expand(rootIndex);
+    updateInfoLabel();
+}
+
+void MainWindow::opened(TreeItem *databaseItem)
+{
+    QModelIndex index = m_treeModel->index(databaseItem->row(), 0, QModelIndex());
+    ui->treeView->setCurrentIndex(index);
+    ui->treeView->expand(index);
 
     updateInfoLabel();
+
+    // Database connection is set up right after the tree is shown
+    QTimer::singleShot(0, this, [this, databaseItem]() {
+        if (!m_workspace->contains(databaseItem))
+            return;
+        SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+        if (!sqlCore->openPending())
+            QMessageBox::critical(this, "Error!", sqlCore->lastErrorMsg());
+    });
+}
+
+void MainWindow::failed(const QString &path, const QString &errorMsg)
+{
+    updateInfoLabel();
+    QMessageBox::critical(this, "Error!", QString("%1: %2").arg(QFileInfo(path).fileName(), errorMsg));
 }
 
 void MainWindow::updateInfoLabel()
 {
-    if (!m_rootItem) {
-        ui->infoLabel->setText("No information available");
+    const int loading = m_workspace->loadingCount();
+    const QString loadingInfo = loading ? QString("Loading %1 database(s)... ").arg(loading) : QString();
+
+    TreeItem *databaseItem = currentDatabase();
+    SqlCore *sqlCore = m_workspace->sqlCore(databaseItem);
+
+    if (!sqlCore) {
+        ui->infoLabel->setText(loadingInfo + "No information available");
         return;
     }
 
     const QStringList units = QStringList() << "bytes" << "kB" << "MB" << "GB" << "TB";
-    double size = (double)m_sqlCore->totalSize();
-    qint64 n = m_sqlCore->totalSize();
+    double size = (double)sqlCore->totalSize();
+    qint64 n = sqlCore->totalSize();
     int i = 0;
 
     for (; n >= 1024; n /= 1024, i++)
         size /= 1024.0;
 
-    QString info = QString("Files: %1, folders: %2, total size: %3 %4")
-                       .arg(m_sqlCore->fileCount())
-                       .arg(m_sqlCore->folderCount())
+    // Huge folders not fetched completely yet
+    const bool partial = databaseItem->aggregate() && databaseItem->aggregate()->partialCount;
+
+    QString info = QString("Files: %1%2, folders: %3, total size: %4 %5")
+                       .arg(sqlCore->fileCount())
+                       .arg(partial ? "+" : "")
+                       .arg(sqlCore->folderCount())
                        .arg(size, 0, 'f', i < 1 ? 0 : 2)
                        .arg(units.at(i));
 
-    ui->infoLabel->setText(info);
-}
-
-void MainWindow::exportTreeItems(QDir dir, TreeItem *parent, bool *ok)
-{
-    for (int i = 0; i < parent->childCount(); i++) {
-        TreeItem *child = parent->childItem(i);
-        if (child->isFoler()) {
-            if (dir.mkdir(child->name())) {
-                dir.cd(child->name());
-                // Recursion to export subdirs
-                exportTreeItems(dir, child, ok);
-                dir.cdUp();
-            } else
-                *ok = false;
-        } else {
-            QFile f(dir.absolutePath() + QDir::separator() + child->name());
-            if (f.open(QIODevice::WriteOnly)) {
-                if (f.write(m_sqlCore->rawData(child)) != child->size())
-                    *ok = false;
-                f.close();
-            } else
-                *ok = false;
-        }
-    }
+    ui->infoLabel->setText(loadingInfo + info);
 }
@@ -10,8 +10,11 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QPointer>
 #include "SqlCore/SqlCore.h"
 #include "TreeModel/TreeModel.h"
+#include "Workspace/Workspace.h"
+#include "DataViewDialog/DataViewDialog.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -27,12 +30,28 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
     void open(const QString &path);
+    void setCredentials(const QString &user, const QString &password);
+    void setEngine(SqlCore::Engine engine);
+    void setInflateEngine(const QString &name);
+    void startTrace(const QString &path);
 
 private slots:
     void openFile();
+    void closeDatabase();
     void exportAll();
+    void exportFiltered();
+    void convertToSqlite();
+    void repack();
+    void compareWith();
+    void compareRecords();
+    void profileGrid();
+    void verify();
+    void trace(bool enabled);
     void about();
     void dataView(const QModelIndex &index);
+    void opened(TreeItem *databaseItem);
+    void failed(const QString &path, const QString &errorMsg);
+    void updateInfoLabel();
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event);
@@ -40,11 +59,16 @@ protected:
 
 private:
     Ui::MainWindow *ui;
-    SqlCore *m_sqlCore;
-    TreeItem *m_rootItem;
+    Workspace *m_workspace;
     TreeModel *m_treeModel;
+    // Open file viewers by database item, closed with the database
+    QMultiHash<TreeItem*, QPointer<DataViewDialog>> m_viewers;
 
-    void updateInfoLabel();
-    void exportTreeItems(QDir dir, TreeItem *parent, bool *ok);
+    // Database of the current tree view item, the first one if there is no current item
+    TreeItem *currentDatabase();
+    // Loads files of huge folders not fetched yet, operations on whole tree need them all.
+    // Shows error message and returns false if loading fails.
+    bool fetchAll(TreeItem *item);
+    static bool isSupportedFile(const QString &name);
 };
 #endif // MAINWINDOW_H
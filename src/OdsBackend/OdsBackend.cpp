@@ -0,0 +1,204 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "OdsBackend.h"
+#include "Tracer/Tracer.h"
+
+OdsBackend::OdsBackend()
+{
+
+}
+
+bool OdsBackend::open(const QString &path)
+{
+    close();
+
+    if (!m_reader.open(path))
+        return false;
+
+    if (!loadFolders() || !loadFiles()) {
+        const QString msg = m_lastErrorMsg;
+        close();
+        m_lastErrorMsg = msg;
+        return false;
+    }
+
+    return true;
+}
+
+void OdsBackend::close()
+{
+    m_reader.close();
+    m_lastErrorMsg.clear();
+    m_folders.clear();
+    m_files.clear();
+    m_blobs.clear();
+}
+
+QString OdsBackend::lastErrorMsg() const
+{
+    if (!m_lastErrorMsg.isEmpty())
+        return m_lastErrorMsg;
+    else
+        return m_reader.lastErrorMsg();
+}
+
+QVector<FolderRecord> OdsBackend::folders(int parentId)
+{
+    return m_folders.value(parentId);
+}
+
+QVector<FileRecord> OdsBackend::files(int folderId)
+{
+    return m_files.value(folderId);
+}
+
+bool OdsBackend::files(int folderId, int afterId, int limit, QVector<FileRecord> *files)
+{
+    const QVector<FileRecord> records = m_files.value(folderId);
+
+    // Records are sorted by ID on loading
+    auto first = std::upper_bound(records.cbegin(), records.cend(), afterId,
+                                  [](int id, const FileRecord &record) { return id < record.id; });
+    const int offset = first - records.cbegin();
+
+    *files = records.mid(offset, limit);
+    return true;
+}
+
+bool OdsBackend::findFiles(const FileFilter &filter, QVector<FileRecord> *files)
+{
+    // Tables are in memory already, so the filter is simply applied to them
+    const QRegularExpression name(QRegularExpression::wildcardToRegularExpression(filter.name),
+                                  QRegularExpression::CaseInsensitiveOption);
+
+    QList<int> folderIds;
+    if (filter.folderIds.isEmpty())
+        folderIds = m_files.keys();
+    else
+        folderIds = filter.folderIds.toList();
+
+    files->clear();
+
+    for (int folderId : qAsConst(folderIds)) {
+        const QVector<FileRecord> records = m_files.value(folderId);
+        for (const FileRecord &record : records) {
+            if (!filter.kinds.isEmpty() && !filter.kinds.contains(record.kind))
+                continue;
+            if (filter.from.isValid() && !(record.ctime >= filter.from))
+                continue;
+            if (filter.to.isValid() && !(record.ctime <= filter.to))
+                continue;
+            if ((filter.minSize >= 0) && (record.size < filter.minSize))
+                continue;
+            if ((filter.maxSize >= 0) && (record.size > filter.maxSize))
+                continue;
+            if (!filter.name.isEmpty() && !name.match(record.name).hasMatch())
+                continue;
+            files->append(record);
+        }
+    }
+
+    return true;
+}
+
+QByteArray OdsBackend::blob(int id, const QString &blobName)
+{
+    TRACE_SCOPE("fetch blob");
+
+    if (!m_blobs.contains(id))
+        return QByteArray();
+
+    const QPair<quint64, quint64> blobs = m_blobs.value(id);
+    const quint64 blobId = (blobName == "PROFILE") ? blobs.second : blobs.first;
+
+    // Zero blob ID means NULL
+    if (!blobId)
+        return QByteArray();
+
+    const QByteArray data = m_reader.blob(blobId);
+    Tracer::count("bytes fetched", data.size());
+    return data;
+}
+
+void OdsBackend::sortByStorage(QVector<int> *ids)
+{
+    // Page of DATA BLOB header, then the line on the page
+    QHash<int, QPair<quint32, quint64>> keys;
+    keys.reserve(ids->count());
+    for (int id : qAsConst(*ids)) {
+        const quint64 blobId = m_blobs.value(id).first;
+        keys.insert(id, qMakePair(blobId ? m_reader.blobPage(blobId) : 0, blobId));
+    }
+
+    std::sort(ids->begin(), ids->end(), [&keys](int a, int b) {
+        return keys.value(a) < keys.value(b);
+    });
+}
+
+bool OdsBackend::loadFolders()
+{
+    const int relationId = m_reader.relationId("FOLDERS");
+    const int idField = m_reader.fieldId("FOLDERS", "ID");
+    const int parentField = m_reader.fieldId("FOLDERS", "PARENTID");
+    const int nameField = m_reader.fieldId("FOLDERS", "FOLDERNAME");
+
+    if ((relationId < 0) || (idField < 0) || (parentField < 0) || (nameField < 0)) {
+        m_lastErrorMsg = "FOLDERS table not found.";
+        return false;
+    }
+
+    return m_reader.scan(relationId, [&](const OdsReader::Record &record) {
+        FolderRecord folder;
+        folder.id = record.value(idField).toInt();
+        folder.parentId = record.value(parentField).toInt();
+        folder.name = record.value(nameField).toString();
+        m_folders[folder.parentId].append(folder);
+        return true;
+    });
+}
+
+bool OdsBackend::loadFiles()
+{
+    const int relationId = m_reader.relationId("DATA");
+    const int idField = m_reader.fieldId("DATA", "ID");
+    const int folderField = m_reader.fieldId("DATA", "FOLDERID");
+    const int nameField = m_reader.fieldId("DATA", "MODULENAME");
+    const int kindField = m_reader.fieldId("DATA", "KIND");
+    const int sizeField = m_reader.fieldId("DATA", "DATASIZE");
+    const int ctimeField = m_reader.fieldId("DATA", "CREATEDDATE");
+    const int dataField = m_reader.fieldId("DATA", "DATA");
+    const int profileField = m_reader.fieldId("DATA", "PROFILE");
+
+    if ((relationId < 0) || (idField < 0) || (folderField < 0) || (nameField < 0) || (kindField < 0)
+        || (sizeField < 0) || (ctimeField < 0) || (dataField < 0) || (profileField < 0)) {
+        m_lastErrorMsg = "DATA table not found.";
+        return false;
+    }
+
+    const bool ok = m_reader.scan(relationId, [&](const OdsReader::Record &record) {
+        FileRecord file;
+        file.id = record.value(idField).toInt();
+        file.folderId = record.value(folderField).toInt();
+        file.name = record.value(nameField).toString();
+        file.kind = record.value(kindField).toInt();
+        file.size = record.value(sizeField).toInt();
+        file.ctime = record.value(ctimeField).toDateTime();
+        m_files[file.folderId].append(file);
+        m_blobs.insert(file.id, qMakePair(record.value(dataField).toULongLong(),
+                                          record.value(profileField).toULongLong()));
+        return true;
+    });
+
+    // ID order is needed for paged reading
+    for (QVector<FileRecord> &records : m_files)
+        std::sort(records.begin(), records.end(),
+                  [](const FileRecord &a, const FileRecord &b) { return a.id < b.id; });
+
+    return ok;
+}
@@ -0,0 +1,46 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef ODSBACKEND_H
+#define ODSBACKEND_H
+
+#include "StorageBackend/StorageBackend.h"
+#include "OdsReader/OdsReader.h"
+
+// PC-3000 database files read directly from disk by OdsReader,
+// FOLDERS & DATA tables are loaded into memory on opening
+class OdsBackend : public StorageBackend
+{
+public:
+    OdsBackend();
+
+    QString name() const override { return "Native"; }
+    bool open(const QString &path) override;
+    void close() override;
+    QString lastErrorMsg() const override;
+
+    QVector<FolderRecord> folders(int parentId) override;
+    QVector<FileRecord> files(int folderId) override;
+    bool files(int folderId, int afterId, int limit, QVector<FileRecord> *files) override;
+    bool findFiles(const FileFilter &filter, QVector<FileRecord> *files) override;
+    QByteArray blob(int id, const QString &blobName) override;
+    void sortByStorage(QVector<int> *ids) override;
+
+private:
+    OdsReader m_reader;
+    QString m_lastErrorMsg;
+
+    QHash<int, QVector<FolderRecord>> m_folders;    // Parent ID -> folders
+    QHash<int, QVector<FileRecord>> m_files;        // Folder ID -> files
+    QHash<int, QPair<quint64, quint64>> m_blobs;    // Record ID -> DATA & PROFILE blob IDs
+
+    bool loadFolders();
+    bool loadFiles();
+};
+
+#endif // ODSBACKEND_H
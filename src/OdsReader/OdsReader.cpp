@@ -0,0 +1,918 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "OdsReader.h"
+#include <QtEndian>
+
+// System relations
+static const int rel_pages = 0;
+static const int rel_rfr = 5;
+static const int rel_relations = 6;
+static const int rel_formats = 8;
+
+// Default format key, used when record format is not found in RDB$FORMATS
+static const int defaultFormat = -1;
+
+// Pages kept in memory when the file can't be mapped
+static const int pageCacheSize = 1024;
+
+// Record number of a BLOB is 40 bits wide, relation ID is kept above it
+static const int blobRelationShift = 40;
+
+typedef QPair<quint8, quint16> SystemField;
+
+// RDB$PAGES: RDB$PAGE_NUMBER, RDB$RELATION_ID, RDB$PAGE_SEQUENCE, RDB$PAGE_TYPE
+static const QVector<SystemField> pagesFields = {
+    { dtype_long, 4 }, { dtype_short, 2 }, { dtype_long, 4 }, { dtype_short, 2 }
+};
+
+// RDB$FORMATS: RDB$RELATION_ID, RDB$FORMAT, RDB$DESCRIPTOR
+static const QVector<SystemField> formatsFields = {
+    { dtype_short, 2 }, { dtype_short, 2 }, { dtype_blob, 8 }
+};
+
+static QVector<SystemField> relationsFields(quint16 nameLength, int count)
+{
+    // RDB$VIEW_BLR, RDB$VIEW_SOURCE, RDB$DESCRIPTION, RDB$RELATION_ID,
+    // RDB$SYSTEM_FLAG, RDB$DBKEY_LENGTH, RDB$FORMAT, RDB$FIELD_ID,
+    // RDB$RELATION_NAME, RDB$SECURITY_CLASS, RDB$EXTERNAL_FILE, RDB$RUNTIME,
+    // RDB$EXTERNAL_DESCRIPTION, RDB$OWNER_NAME, RDB$DEFAULT_CLASS, RDB$FLAGS,
+    // RDB$RELATION_TYPE (ODS 11.1)
+    QVector<SystemField> fields = {
+        { dtype_blob, 8 }, { dtype_blob, 8 }, { dtype_blob, 8 }, { dtype_short, 2 },
+        { dtype_short, 2 }, { dtype_short, 2 }, { dtype_short, 2 }, { dtype_short, 2 },
+        { dtype_text, nameLength }, { dtype_text, nameLength }, { dtype_varying, 257 }, { dtype_blob, 8 },
+        { dtype_blob, 8 }, { dtype_text, nameLength }, { dtype_text, nameLength }, { dtype_short, 2 },
+        { dtype_short, 2 }
+    };
+    return fields.mid(0, count);
+}
+
+static QVector<SystemField> relationFieldsFields(quint16 nameLength)
+{
+    // RDB$FIELD_NAME, RDB$RELATION_NAME, RDB$FIELD_SOURCE, RDB$QUERY_NAME,
+    // RDB$BASE_FIELD, RDB$EDIT_STRING, RDB$FIELD_POSITION, RDB$QUERY_HEADER,
+    // RDB$UPDATE_FLAG, RDB$FIELD_ID, RDB$VIEW_CONTEXT, RDB$DESCRIPTION,
+    // RDB$DEFAULT_VALUE, RDB$SYSTEM_FLAG, RDB$SECURITY_CLASS, RDB$COMPLEX_NAME,
+    // RDB$NULL_FLAG, RDB$DEFAULT_SOURCE, RDB$COLLATION_ID
+    return {
+        { dtype_text, nameLength }, { dtype_text, nameLength }, { dtype_text, nameLength }, { dtype_text, nameLength },
+        { dtype_text, nameLength }, { dtype_varying, 129 }, { dtype_short, 2 }, { dtype_blob, 8 },
+        { dtype_short, 2 }, { dtype_short, 2 }, { dtype_short, 2 }, { dtype_blob, 8 },
+        { dtype_blob, 8 }, { dtype_short, 2 }, { dtype_text, nameLength }, { dtype_text, nameLength },
+        { dtype_short, 2 }, { dtype_blob, 8 }, { dtype_short, 2 }
+    };
+}
+
+static int alignment(quint8 type)
+{
+    switch (type) {
+    case dtype_varying:
+    case dtype_short:
+        return 2;
+    case dtype_long:
+    case dtype_quad:
+    case dtype_real:
+    case dtype_sql_date:
+    case dtype_sql_time:
+    case dtype_timestamp:
+    case dtype_blob:
+    case dtype_array:
+        return 4;
+    case dtype_double:
+    case dtype_int64:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+static QVariant scaled(qint64 value, int scale)
+{
+    if (scale >= 0)
+        return value;
+
+    double result = value;
+    for (int i = 0; i < -scale; i++)
+        result /= 10.0;
+    return result;
+}
+
+OdsReader::OdsReader() :
+    m_map(nullptr),
+    m_pageSize(0),
+    m_pageCount(0),
+    m_maxRecords(0),
+    m_pageCache(pageCacheSize)
+{
+
+}
+
+OdsReader::~OdsReader()
+{
+    close();
+}
+
+bool OdsReader::isOdsFile(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    ods_header_page_t header;
+    if (f.read((char *)&header, sizeof(header)) != sizeof(header))
+        return false;
+
+    const quint16 version = header.hdr_ods_version & 0x7FFF;
+
+    return (header.hdr_header.pag_type == pag_header)
+           && ((version == 10) || (version == 11))
+           && (header.hdr_page_size >= 1024)
+           && (header.hdr_page_size <= 16384)
+           && ((header.hdr_page_size & (header.hdr_page_size - 1)) == 0);
+}
+
+bool OdsReader::open(const QString &path)
+{
+    close();
+
+    if (!isOdsFile(path)) {
+        m_lastErrorMsg = "Unsupported database file, Firebird ODS 10 or 11 expected.";
+        return false;
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_lastErrorMsg = m_file.errorString();
+        return false;
+    }
+
+    ods_header_page_t header;
+    m_file.read((char *)&header, sizeof(header));
+
+    m_pageSize = header.hdr_page_size;
+    m_pageCount = m_file.size() / m_pageSize;
+    m_maxRecords = (m_pageSize - ODS_DPG_SIZE) / (sizeof(ods_data_page_t::dpg_rpt) + ODS_RHD_SIZE);
+
+    // Whole file mapping gives zero-copy access, pages are read
+    // one by one if there is no enough address space for it
+    m_map = m_file.map(0, m_file.size());
+
+    if (!loadPages(header.hdr_PAGES) || !loadFormats() || !loadRelations()) {
+        const QString msg = m_lastErrorMsg;
+        close();
+        m_lastErrorMsg = msg;
+        return false;
+    }
+
+    return true;
+}
+
+void OdsReader::close()
+{
+    if (m_map) {
+        m_file.unmap((uchar *)m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+
+    m_pageSize = 0;
+    m_pageCount = 0;
+    m_maxRecords = 0;
+    m_pageCache.clear();
+    m_pointerPages.clear();
+    m_formats.clear();
+    m_relations.clear();
+    m_fields.clear();
+    m_dataPages.clear();
+    m_mappedRelations.clear();
+    m_lastErrorMsg.clear();
+}
+
+int OdsReader::fieldId(const QString &relation, const QString &field) const
+{
+    return m_fields.value(relation).value(field, -1);
+}
+
+bool OdsReader::scan(int relationId, const Visitor &visitor)
+{
+    return scanPages(relationId, nullptr, visitor);
+}
+
+QByteArray OdsReader::page(quint32 number)
+{
+    if (number >= m_pageCount)
+        return QByteArray();
+
+    if (m_map)
+        return QByteArray::fromRawData((const char *)m_map + (qint64)number * m_pageSize, m_pageSize);
+
+    QByteArray *cached = m_pageCache.object(number);
+    if (cached)
+        return *cached;
+
+    QByteArray data(m_pageSize, Qt::Uninitialized);
+    if (!m_file.seek((qint64)number * m_pageSize)
+        || (m_file.read(data.data(), m_pageSize) != m_pageSize))
+        return QByteArray();
+
+    m_pageCache.insert(number, new QByteArray(data));
+    return data;
+}
+
+bool OdsReader::loadPages(quint32 firstPointerPage)
+{
+    // RDB$PAGES pointer pages are chained starting from the header page
+    QVector<quint32> chain;
+    for (quint32 number = firstPointerPage; number && (chain.count() < (int)m_pageCount); ) {
+        const QByteArray data = page(number);
+        if (data.isEmpty())
+            break;
+
+        ods_pointer_page_t header;
+        memcpy(&header, data.constData(), offsetof(ods_pointer_page_t, ppg_page));
+        if ((header.ppg_header.pag_type != pag_pointer) || (header.ppg_relation != rel_pages))
+            break;
+
+        chain.append(number);
+        number = header.ppg_next;
+    }
+
+    if (chain.isEmpty()) {
+        m_lastErrorMsg = "RDB$PAGES pointer page not found.";
+        return false;
+    }
+
+    m_pointerPages.insert(rel_pages, chain);
+    m_formats[rel_pages].insert(defaultFormat, systemFormat(pagesFields));
+
+    // Pointer pages of all other relations, ordered by sequence
+    QHash<int, QMap<int, quint32>> pointerPages;
+    scan(rel_pages, [&](const Record &record) {
+        if (record.value(3).toInt() == pag_pointer)
+            pointerPages[record.value(1).toInt()].insert(record.value(2).toInt(), record.value(0).toUInt());
+        return true;
+    });
+
+    for (auto it = pointerPages.constBegin(); it != pointerPages.constEnd(); ++it)
+        if (it.key() != rel_pages)
+            m_pointerPages.insert(it.key(), it.value().values().toVector());
+
+    if (!m_pointerPages.contains(rel_formats) || !m_pointerPages.contains(rel_relations)) {
+        m_lastErrorMsg = "System relations not found in RDB$PAGES.";
+        return false;
+    }
+
+    return true;
+}
+
+bool OdsReader::loadFormats()
+{
+    const QVector<Field> format = systemFormat(formatsFields);
+    m_formats[rel_formats].insert(defaultFormat, format);
+
+    // Descriptors are read after the scan, it may map data pages itself
+    QVector<QPair<QPair<int, int>, quint64>> descriptors;
+    scanPages(rel_formats, &format, [&](const Record &record) {
+        if (!record.value(2).isNull())
+            descriptors.append(qMakePair(qMakePair(record.value(0).toInt(), record.value(1).toInt()),
+                                         record.value(2).toULongLong()));
+        return true;
+    });
+
+    for (const auto &descriptor : descriptors) {
+        const QVector<Field> format = parseFormat(blob(descriptor.second));
+        if (!format.isEmpty())
+            m_formats[descriptor.first.first].insert(descriptor.first.second, format);
+    }
+
+    if (descriptors.isEmpty()) {
+        m_lastErrorMsg = "RDB$FORMATS is empty.";
+        return false;
+    }
+
+    return true;
+}
+
+bool OdsReader::loadRelations()
+{
+    static const QHash<QString, int> knownRelations = {
+        { "RDB$PAGES", 0 }, { "RDB$DATABASE", 1 }, { "RDB$FIELDS", 2 },
+        { "RDB$INDEX_SEGMENTS", 3 }, { "RDB$INDICES", 4 }, { "RDB$RELATION_FIELDS", 5 },
+        { "RDB$RELATIONS", 6 }, { "RDB$VIEW_RELATIONS", 7 }, { "RDB$FORMATS", 8 }
+    };
+
+    // System relation formats are usually stored in RDB$FORMATS, engine layouts
+    // are tried otherwise. Right one is recognized by known system relations.
+    QVector<QVector<Field>> candidates;
+    candidates.append(QVector<Field>());
+    for (quint16 nameLength : { 31, 93 })
+        for (int count : { 17, 16 })
+            candidates.append(systemFormat(relationsFields(nameLength, count)));
+
+    bool found = false;
+    for (const QVector<Field> &candidate : candidates) {
+        QVector<Record> records;
+        scanPages(rel_relations, candidate.isEmpty() ? nullptr : &candidate, [&](const Record &record) {
+            records.append(record);
+            return true;
+        });
+
+        const int fieldCount = records.isEmpty() ? 0 : records.first().count();
+        for (int nameField = 0; !found && (nameField < fieldCount); nameField++)
+            for (int idField = 0; !found && (idField < fieldCount); idField++) {
+                if (nameField == idField)
+                    continue;
+
+                int matches = 0;
+                for (const Record &record : records) {
+                    const QVariant name = record.value(nameField);
+                    const QVariant id = record.value(idField);
+                    if ((name.type() == QVariant::String) && (id.type() == QVariant::Int)
+                        && (knownRelations.value(name.toString().trimmed(), -1) == id.toInt()))
+                        matches++;
+                }
+
+                if (matches == knownRelations.count()) {
+                    for (const Record &record : records)
+                        m_relations.insert(record.value(nameField).toString().trimmed(),
+                                           record.value(idField).toInt());
+                    found = true;
+                }
+            }
+
+        if (found)
+            break;
+    }
+
+    if (!found) {
+        m_lastErrorMsg = "Unsupported RDB$RELATIONS layout.";
+        return false;
+    }
+
+    // Relation fields, recognized the same way by RDB$PAGES & RDB$FORMATS fields
+    static const QHash<QString, int> knownFields = {
+        { "RDB$PAGES.RDB$PAGE_NUMBER", 0 }, { "RDB$PAGES.RDB$RELATION_ID", 1 },
+        { "RDB$PAGES.RDB$PAGE_SEQUENCE", 2 }, { "RDB$PAGES.RDB$PAGE_TYPE", 3 },
+        { "RDB$FORMATS.RDB$RELATION_ID", 0 }, { "RDB$FORMATS.RDB$FORMAT", 1 },
+        { "RDB$FORMATS.RDB$DESCRIPTOR", 2 }
+    };
+
+    candidates.clear();
+    candidates.append(QVector<Field>());
+    for (quint16 nameLength : { 31, 93 })
+        candidates.append(systemFormat(relationFieldsFields(nameLength)));
+
+    found = false;
+    for (const QVector<Field> &candidate : candidates) {
+        QVector<Record> records;
+        scanPages(rel_rfr, candidate.isEmpty() ? nullptr : &candidate, [&](const Record &record) {
+            records.append(record);
+            return true;
+        });
+
+        const int fieldCount = records.isEmpty() ? 0 : records.first().count();
+        for (int nameField = 0; !found && (nameField < fieldCount); nameField++)
+            for (int relationField = 0; !found && (relationField < fieldCount); relationField++) {
+                if (nameField == relationField)
+                    continue;
+
+                // Quick check before looking for field ID
+                bool pagesFound = false;
+                for (const Record &record : records)
+                    if ((record.value(relationField).toString().trimmed() == "RDB$PAGES")
+                        && (record.value(nameField).toString().trimmed() == "RDB$PAGE_NUMBER")) {
+                        pagesFound = true;
+                        break;
+                    }
+                if (!pagesFound)
+                    continue;
+
+                for (int idField = 0; !found && (idField < fieldCount); idField++) {
+                    if ((idField == nameField) || (idField == relationField))
+                        continue;
+
+                    int matches = 0;
+                    for (const Record &record : records) {
+                        const QString key = record.value(relationField).toString().trimmed()
+                                            + "." + record.value(nameField).toString().trimmed();
+                        const QVariant id = record.value(idField);
+                        if ((id.type() == QVariant::Int) && (knownFields.value(key, -1) == id.toInt()))
+                            matches++;
+                    }
+
+                    if (matches == knownFields.count()) {
+                        for (const Record &record : records)
+                            m_fields[record.value(relationField).toString().trimmed()]
+                                .insert(record.value(nameField).toString().trimmed(),
+                                        record.value(idField).toInt());
+                        found = true;
+                    }
+                }
+            }
+
+        if (found)
+            break;
+    }
+
+    if (!found) {
+        m_lastErrorMsg = "Unsupported RDB$RELATION_FIELDS layout.";
+        return false;
+    }
+
+    return true;
+}
+
+bool OdsReader::scanPages(int relationId, const QVector<Field> *forcedFormat, const Visitor &visitor)
+{
+    const QVector<quint32> pointerPages = m_pointerPages.value(relationId);
+    const QHash<int, QVector<Field>> formats = m_formats.value(relationId);
+    QHash<quint32, quint32> sequences;
+
+    const quint32 maxSlots = (m_pageSize - offsetof(ods_pointer_page_t, ppg_page)) / sizeof(quint32);
+
+    for (quint32 pointerPage : pointerPages) {
+        const QByteArray ppData = page(pointerPage);
+        if (ppData.isEmpty())
+            return false;
+
+        ods_pointer_page_t ppHeader;
+        memcpy(&ppHeader, ppData.constData(), offsetof(ods_pointer_page_t, ppg_page));
+        if ((ppHeader.ppg_header.pag_type != pag_pointer) || (ppHeader.ppg_relation != relationId)) {
+            m_lastErrorMsg = QString("Wrong pointer page %1 of relation %2.").arg(pointerPage).arg(relationId);
+            return false;
+        }
+
+        const uchar *slots = (const uchar *)ppData.constData() + offsetof(ods_pointer_page_t, ppg_page);
+        for (quint32 slot = 0; slot < qMin<quint32>(ppHeader.ppg_count, maxSlots); slot++) {
+            const quint32 dataPage = qFromLittleEndian<quint32>(slots + slot * sizeof(quint32));
+            if (!dataPage)
+                continue;
+
+            const QByteArray dpData = page(dataPage);
+            if (dpData.isEmpty())
+                continue;
+
+            ods_data_page_t dpHeader;
+            memcpy(&dpHeader, dpData.constData(), offsetof(ods_data_page_t, dpg_rpt));
+            if ((dpHeader.dpg_header.pag_type != pag_data) || (dpHeader.dpg_relation != relationId))
+                continue;
+
+            sequences.insert(dpHeader.dpg_sequence, dataPage);
+
+            for (int line = 0; line < dpHeader.dpg_count; line++) {
+                QByteArray data;
+                int format;
+                if (!recordData(dpData, line, &data, &format))
+                    continue;
+
+                const QVector<Field> *fields = forcedFormat;
+                if (!fields) {
+                    auto it = formats.constFind(format);
+                    if (it == formats.constEnd())
+                        it = formats.constFind(defaultFormat);
+                    if (it == formats.constEnd())
+                        continue;
+                    fields = &it.value();
+                }
+
+                if (!visitor(decode(data, *fields))) {
+                    QHash<quint32, quint32> &known = m_dataPages[relationId];
+                    for (auto it = sequences.constBegin(); it != sequences.constEnd(); ++it)
+                        known.insert(it.key(), it.value());
+                    return true;
+                }
+            }
+        }
+    }
+
+    // All data pages of the relation are known now
+    m_dataPages.insert(relationId, sequences);
+    m_mappedRelations.insert(relationId);
+
+    return true;
+}
+
+bool OdsReader::recordData(const QByteArray &dataPage, int line, QByteArray *out, int *format)
+{
+    const uchar *base = (const uchar *)dataPage.constData();
+    const uchar *slot = base + offsetof(ods_data_page_t, dpg_rpt) + line * sizeof(ods_data_page_t::dpg_rpt);
+    const quint16 offset = qFromLittleEndian<quint16>(slot);
+    const quint16 length = qFromLittleEndian<quint16>(slot + sizeof(quint16));
+
+    if (!offset || (length < ODS_RHD_SIZE) || ((quint32)offset + length > m_pageSize))
+        return false;
+
+    ods_record_header_t header;
+    memcpy(&header, base + offset, ODS_RHD_SIZE);
+
+    // Only primary versions of complete records are visible
+    if (header.rhd_flags & (rhd_deleted | rhd_chain | rhd_fragment | rhd_blob | rhd_damaged))
+        return false;
+
+    *format = header.rhd_format;
+    out->clear();
+
+    if (!(header.rhd_flags & rhd_incomplete))
+        return decompress(base + offset + ODS_RHD_SIZE, length - ODS_RHD_SIZE, out);
+
+    // Fragmented record: first part is here, the rest is chained
+    if (length < ODS_RHDF_SIZE)
+        return false;
+
+    ods_fragment_header_t fragmentHeader;
+    memcpy(&fragmentHeader, base + offset, ODS_RHDF_SIZE);
+
+    if (!decompress(base + offset + ODS_RHDF_SIZE, length - ODS_RHDF_SIZE, out))
+        return false;
+
+    return fragmentData(fragmentHeader.rhdf_f_page, fragmentHeader.rhdf_f_line, out);
+}
+
+bool OdsReader::fragmentData(quint32 pageNumber, int line, QByteArray *out)
+{
+    // Page count limits the chain length, damaged chain can't loop forever
+    for (quint32 i = 0; i < m_pageCount; i++) {
+        const QByteArray dpData = page(pageNumber);
+        if (dpData.isEmpty())
+            return false;
+
+        const uchar *base = (const uchar *)dpData.constData();
+
+        ods_data_page_t dpHeader;
+        memcpy(&dpHeader, base, offsetof(ods_data_page_t, dpg_rpt));
+        if ((dpHeader.dpg_header.pag_type != pag_data) || (line >= dpHeader.dpg_count))
+            return false;
+
+        const uchar *slot = base + offsetof(ods_data_page_t, dpg_rpt) + line * sizeof(ods_data_page_t::dpg_rpt);
+        const quint16 offset = qFromLittleEndian<quint16>(slot);
+        const quint16 length = qFromLittleEndian<quint16>(slot + sizeof(quint16));
+        if (!offset || (length < ODS_RHD_SIZE) || ((quint32)offset + length > m_pageSize))
+            return false;
+
+        ods_record_header_t header;
+        memcpy(&header, base + offset, ODS_RHD_SIZE);
+        if (!(header.rhd_flags & rhd_fragment))
+            return false;
+
+        if (!(header.rhd_flags & rhd_incomplete))
+            return decompress(base + offset + ODS_RHD_SIZE, length - ODS_RHD_SIZE, out);
+
+        if (length < ODS_RHDF_SIZE)
+            return false;
+
+        ods_fragment_header_t fragmentHeader;
+        memcpy(&fragmentHeader, base + offset, ODS_RHDF_SIZE);
+
+        if (!decompress(base + offset + ODS_RHDF_SIZE, length - ODS_RHDF_SIZE, out))
+            return false;
+
+        pageNumber = fragmentHeader.rhdf_f_page;
+        line = fragmentHeader.rhdf_f_line;
+    }
+
+    return false;
+}
+
+bool OdsReader::decompress(const uchar *in, int length, QByteArray *out)
+{
+    // Run length compression: positive control byte is followed by so many
+    // literal bytes, negative one is followed by a byte repeated -n times
+    const uchar *end = in + length;
+
+    while (in < end) {
+        const int n = (qint8)*in++;
+        if (n < 0) {
+            if (in >= end)
+                return false;
+            out->append(-n, (char)*in++);
+        } else {
+            if (in + n > end)
+                return false;
+            out->append((const char *)in, n);
+            in += n;
+        }
+    }
+
+    return true;
+}
+
+OdsReader::Record OdsReader::decode(const QByteArray &data, const QVector<Field> &format)
+{
+    Record record(format.count());
+    const uchar *base = (const uchar *)data.constData();
+    const quint32 size = data.size();
+
+    for (int id = 0; id < format.count(); id++) {
+        const Field &field = format.at(id);
+
+        // Dropped field or field added by later format
+        if (!field.type || (field.offset + field.length > size) || ((quint32)(id >> 3) >= size))
+            continue;
+
+        // Null flags bitmap is at the beginning of the record
+        if (base[id >> 3] & (1 << (id & 7)))
+            continue;
+
+        const uchar *p = base + field.offset;
+
+        switch (field.type) {
+        case dtype_text:
+            record[id] = QString::fromLocal8Bit((const char *)p, field.length);
+            break;
+        case dtype_cstring:
+            record[id] = QString::fromLocal8Bit((const char *)p, qstrnlen((const char *)p, field.length));
+            break;
+        case dtype_varying: {
+            const quint16 length = qMin<quint16>(qFromLittleEndian<quint16>(p), field.length - sizeof(quint16));
+            record[id] = QString::fromLocal8Bit((const char *)p + sizeof(quint16), length);
+            break;
+        }
+        case dtype_short:
+            if (field.scale >= 0)
+                record[id] = (int)qFromLittleEndian<qint16>(p);
+            else
+                record[id] = scaled(qFromLittleEndian<qint16>(p), field.scale);
+            break;
+        case dtype_long:
+            if (field.scale >= 0)
+                record[id] = (int)qFromLittleEndian<qint32>(p);
+            else
+                record[id] = scaled(qFromLittleEndian<qint32>(p), field.scale);
+            break;
+        case dtype_int64:
+            record[id] = scaled(qFromLittleEndian<qint64>(p), field.scale);
+            break;
+        case dtype_real: {
+            float value;
+            memcpy(&value, p, sizeof(value));
+            record[id] = value;
+            break;
+        }
+        case dtype_double: {
+            double value;
+            memcpy(&value, p, sizeof(value));
+            record[id] = value;
+            break;
+        }
+        case dtype_sql_date:
+            // Days since November 17, 1858
+            record[id] = QDate(1858, 11, 17).addDays(qFromLittleEndian<qint32>(p));
+            break;
+        case dtype_sql_time:
+            // 1/10000 of second since midnight
+            record[id] = QTime(0, 0).addMSecs(qFromLittleEndian<quint32>(p) / 10);
+            break;
+        case dtype_timestamp:
+            record[id] = QDateTime(QDate(1858, 11, 17).addDays(qFromLittleEndian<qint32>(p)),
+                                   QTime(0, 0).addMSecs(qFromLittleEndian<quint32>(p + 4) / 10));
+            break;
+        case dtype_blob:
+        case dtype_quad:
+        case dtype_array: {
+            // Relation ID, reserved byte, upper byte of record number, lower 32 bits
+            const quint64 relation = qFromLittleEndian<quint16>(p);
+            const quint64 number = ((quint64)p[3] << 32) | qFromLittleEndian<quint32>(p + 4);
+            record[id] = (qulonglong)((relation << blobRelationShift) | number);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return record;
+}
+
+quint32 OdsReader::dataPage(int relationId, quint32 sequence)
+{
+    const quint32 number = m_dataPages.value(relationId).value(sequence, 0);
+    if (number || m_mappedRelations.contains(relationId))
+        return number;
+
+    // Relation isn't scanned yet: read data page headers only
+    QHash<quint32, quint32> &sequences = m_dataPages[relationId];
+    const quint32 maxSlots = (m_pageSize - offsetof(ods_pointer_page_t, ppg_page)) / sizeof(quint32);
+
+    for (quint32 pointerPage : m_pointerPages.value(relationId)) {
+        const QByteArray ppData = page(pointerPage);
+        if (ppData.isEmpty())
+            break;
+
+        ods_pointer_page_t ppHeader;
+        memcpy(&ppHeader, ppData.constData(), offsetof(ods_pointer_page_t, ppg_page));
+
+        const uchar *slots = (const uchar *)ppData.constData() + offsetof(ods_pointer_page_t, ppg_page);
+        for (quint32 slot = 0; slot < qMin<quint32>(ppHeader.ppg_count, maxSlots); slot++) {
+            const quint32 dp = qFromLittleEndian<quint32>(slots + slot * sizeof(quint32));
+            const QByteArray dpData = page(dp);
+            if (!dp || dpData.isEmpty())
+                continue;
+
+            ods_data_page_t dpHeader;
+            memcpy(&dpHeader, dpData.constData(), offsetof(ods_data_page_t, dpg_rpt));
+            if ((dpHeader.dpg_header.pag_type == pag_data) && (dpHeader.dpg_relation == relationId))
+                sequences.insert(dpHeader.dpg_sequence, dp);
+        }
+    }
+
+    m_mappedRelations.insert(relationId);
+    return sequences.value(sequence, 0);
+}
+
+quint32 OdsReader::blobPage(quint64 blobId)
+{
+    const int relationId = blobId >> blobRelationShift;
+    const quint64 number = blobId & ((Q_UINT64_C(1) << blobRelationShift) - 1);
+
+    if (!m_maxRecords)
+        return 0;
+
+    return dataPage(relationId, number / m_maxRecords);
+}
+
+QByteArray OdsReader::blob(quint64 blobId)
+{
+    const int relationId = blobId >> blobRelationShift;
+    const quint64 number = blobId & ((Q_UINT64_C(1) << blobRelationShift) - 1);
+
+    if (!m_maxRecords)
+        return QByteArray();
+
+    const QByteArray dpData = page(dataPage(relationId, number / m_maxRecords));
+    const int line = number % m_maxRecords;
+    if (dpData.isEmpty())
+        return QByteArray();
+
+    const uchar *base = (const uchar *)dpData.constData();
+
+    ods_data_page_t dpHeader;
+    memcpy(&dpHeader, base, offsetof(ods_data_page_t, dpg_rpt));
+    if ((dpHeader.dpg_header.pag_type != pag_data) || (line >= dpHeader.dpg_count))
+        return QByteArray();
+
+    const uchar *slot = base + offsetof(ods_data_page_t, dpg_rpt) + line * sizeof(ods_data_page_t::dpg_rpt);
+    const quint16 offset = qFromLittleEndian<quint16>(slot);
+    const quint16 length = qFromLittleEndian<quint16>(slot + sizeof(quint16));
+    if (!offset || (length < ODS_BLH_SIZE) || ((quint32)offset + length > m_pageSize))
+        return QByteArray();
+
+    ods_blob_header_t header;
+    memcpy(&header, base + offset, ODS_BLH_SIZE);
+    if (!(header.blh_flags & rhd_blob))
+        return QByteArray();
+
+    // BLOB contents as stored: segmented BLOB has 16-bit length before every segment
+    QByteArray stored;
+    const uchar *vector = base + offset + ODS_BLH_SIZE;
+    const int vectorLength = length - ODS_BLH_SIZE;
+
+    if (header.blh_level == 0) {
+        // Small BLOB, data is right after the header
+        stored = QByteArray::fromRawData((const char *)vector, vectorLength);
+        if (!m_map)
+            stored.detach();
+    } else {
+        // Level 1: vector of data pages, level 2: vector of pointer pages
+        QVector<quint32> pages;
+        for (int i = 0; i + (int)sizeof(quint32) <= vectorLength; i += sizeof(quint32))
+            pages.append(qFromLittleEndian<quint32>(vector + i));
+
+        if (header.blh_level == 2) {
+            QVector<quint32> dataPages;
+            for (quint32 number : pages) {
+                const QByteArray bpData = page(number);
+                if (bpData.isEmpty())
+                    return QByteArray();
+
+                ods_blob_page_t bpHeader;
+                memcpy(&bpHeader, bpData.constData(), ODS_BLP_SIZE);
+                if (bpHeader.blp_header.pag_type != pag_blob)
+                    return QByteArray();
+
+                const uchar *p = (const uchar *)bpData.constData() + ODS_BLP_SIZE;
+                const int count = qMin<int>(bpHeader.blp_length, m_pageSize - ODS_BLP_SIZE) / sizeof(quint32);
+                for (int i = 0; i < count; i++)
+                    dataPages.append(qFromLittleEndian<quint32>(p + i * sizeof(quint32)));
+            }
+            pages = dataPages;
+        } else if (header.blh_level != 1)
+            return QByteArray();
+
+        stored.reserve(header.blh_length + header.blh_count * sizeof(quint16));
+        for (quint32 number : pages) {
+            const QByteArray bpData = page(number);
+            if (bpData.isEmpty())
+                return QByteArray();
+
+            ods_blob_page_t bpHeader;
+            memcpy(&bpHeader, bpData.constData(), ODS_BLP_SIZE);
+            if (bpHeader.blp_header.pag_type != pag_blob)
+                return QByteArray();
+
+            stored.append(bpData.constData() + ODS_BLP_SIZE,
+                          qMin<int>(bpHeader.blp_length, m_pageSize - ODS_BLP_SIZE));
+        }
+    }
+
+    if (header.blh_flags & rhd_stream_blob)
+        return stored;
+
+    // Single segment needs no copy
+    const uchar *p = (const uchar *)stored.constData();
+    if ((stored.size() >= (int)sizeof(quint16))
+        && (qFromLittleEndian<quint16>(p) == stored.size() - sizeof(quint16))) {
+        if (m_map && (header.blh_level == 0))
+            return QByteArray::fromRawData(stored.constData() + sizeof(quint16), stored.size() - sizeof(quint16));
+        else
+            return stored.mid(sizeof(quint16));
+    }
+
+    QByteArray out;
+    out.reserve(header.blh_length);
+    for (int i = 0; i + (int)sizeof(quint16) <= stored.size(); ) {
+        const int n = qFromLittleEndian<quint16>(p + i);
+        i += sizeof(quint16);
+        if (i + n > stored.size())
+            return QByteArray();
+        out.append(stored.constData() + i, n);
+        i += n;
+    }
+
+    return out;
+}
+
+QVector<OdsReader::Field> OdsReader::parseFormat(const QByteArray &descriptor)
+{
+    auto parse = [](const uchar *p, int count) {
+        QVector<Field> fields;
+        const quint32 flagBytes = (count + 7) / 8;
+
+        for (int i = 0; i < count; i++) {
+            ods_descriptor_t dsc;
+            memcpy(&dsc, p + i * sizeof(ods_descriptor_t), sizeof(ods_descriptor_t));
+
+            Field field;
+            field.type = dsc.dsc_dtype;
+            field.scale = dsc.dsc_scale;
+            field.length = dsc.dsc_length;
+            field.offset = dsc.dsc_offset;
+
+            // Sanity check, wrong guess about descriptor layout fails here
+            if (field.type && ((field.type > dtype_int64) || (field.offset < flagBytes)
+                               || (field.offset + field.length > 65535)))
+                return QVector<Field>();
+
+            fields.append(field);
+        }
+
+        return fields;
+    };
+
+    const uchar *p = (const uchar *)descriptor.constData();
+    const int size = descriptor.size();
+
+    // Firebird 2.5 writes descriptor count first (and default values after
+    // descriptors), older versions write bare array of descriptors
+    if (size >= (int)sizeof(quint16)) {
+        const int count = qFromLittleEndian<quint16>(p);
+        if (count && (sizeof(quint16) + count * sizeof(ods_descriptor_t) <= (size_t)size)) {
+            const QVector<Field> fields = parse(p + sizeof(quint16), count);
+            if (!fields.isEmpty())
+                return fields;
+        }
+    }
+
+    if (size && (size % sizeof(ods_descriptor_t) == 0))
+        return parse(p, size / sizeof(ods_descriptor_t));
+
+    return QVector<Field>();
+}
+
+QVector<OdsReader::Field> OdsReader::systemFormat(const QVector<QPair<quint8, quint16>> &fields)
+{
+    // The same layout engine makes: null flags first, then aligned fields
+    QVector<Field> format;
+    quint32 offset = (fields.count() + 7) / 8;
+
+    for (const auto &item : fields) {
+        const int align = alignment(item.first);
+        offset = (offset + align - 1) / align * align;
+
+        Field field;
+        field.type = item.first;
+        field.scale = 0;
+        field.length = item.second;
+        field.offset = offset;
+        format.append(field);
+
+        offset += item.second;
+    }
+
+    return format;
+}
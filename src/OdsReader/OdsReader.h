@@ -0,0 +1,211 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef ODSREADER_H
+#define ODSREADER_H
+
+#include <QtCore>
+#include <functional>
+
+// Read-only reader of Firebird 2.x on-disk structure (ODS 10 & 11), no
+// client library or engine is needed. Only primary record versions are
+// visible, which is fine for databases nobody writes to at the moment.
+class OdsReader
+{
+public:
+    // Field descriptor of the record format
+    struct Field {
+        quint8 type;        // dtype_*
+        qint8 scale;
+        quint16 length;
+        quint32 offset;     // Offset in uncompressed record
+    };
+
+    // Decoded record: field values indexed by field ID, BLOB fields
+    // are returned as blob IDs (see blob() method)
+    typedef QVector<QVariant> Record;
+    typedef std::function<bool(const Record &)> Visitor;
+
+    OdsReader();
+    ~OdsReader();
+
+    bool open(const QString &path);
+    void close();
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+    // Returns true if file starts with supported ODS header page
+    static bool isOdsFile(const QString &path);
+
+    // User & system relations lookup, -1 if not found
+    int relationId(const QString &name) const { return m_relations.value(name, -1); }
+    int fieldId(const QString &relation, const QString &field) const;
+
+    // Calls visitor for every record of the relation, stops if visitor returns false
+    bool scan(int relationId, const Visitor &visitor);
+
+    // BLOB contents. Data references the mapped file (no copy) when it
+    // is possible, such data is valid until the reader is closed.
+    QByteArray blob(quint64 blobId);
+    // Page holding the BLOB header (large BLOB data pages follow it),
+    // 0 if it is unknown
+    quint32 blobPage(quint64 blobId);
+
+private:
+    QFile m_file;
+    const uchar *m_map;
+    quint32 m_pageSize;
+    quint32 m_pageCount;
+    quint32 m_maxRecords;   // Records per data page
+    QCache<quint32, QByteArray> m_pageCache;
+    QString m_lastErrorMsg;
+
+    QHash<int, QVector<quint32>> m_pointerPages;        // Relation ID -> pointer pages
+    QHash<int, QHash<int, QVector<Field>>> m_formats;   // Relation ID -> format -> fields
+    QHash<QString, int> m_relations;                    // Relation name -> ID
+    QHash<QString, QHash<QString, int>> m_fields;       // Relation name -> field name -> ID
+    QHash<int, QHash<quint32, quint32>> m_dataPages;    // Relation ID -> sequence -> page
+    QSet<int> m_mappedRelations;                        // Relations with complete m_dataPages
+
+    QByteArray page(quint32 number);
+    bool loadPages(quint32 firstPointerPage);
+    bool loadFormats();
+    bool loadRelations();
+    bool scanPages(int relationId, const QVector<Field> *forcedFormat, const Visitor &visitor);
+    bool recordData(const QByteArray &dataPage, int line, QByteArray *out, int *format);
+    bool fragmentData(quint32 pageNumber, int line, QByteArray *out);
+    Record decode(const QByteArray &data, const QVector<Field> &format);
+    quint32 dataPage(int relationId, quint32 sequence);
+
+    static QVector<Field> parseFormat(const QByteArray &descriptor);
+    static QVector<Field> systemFormat(const QVector<QPair<quint8, quint16>> &fields);
+    static bool decompress(const uchar *in, int length, QByteArray *out);
+};
+
+/*************************************************/
+/*********** ODS 11 structures BEGIN *************/
+/*************************************************/
+
+// Page types
+enum OdsPageType { pag_header = 1, pag_pages = 2, pag_transactions = 3, pag_pointer = 4,
+                   pag_data = 5, pag_root = 6, pag_index = 7, pag_blob = 8, pag_ids = 9 };
+
+// Record header flags
+enum OdsRecordFlags { rhd_deleted = 1, rhd_chain = 2, rhd_fragment = 4, rhd_incomplete = 8,
+                      rhd_blob = 16, rhd_stream_blob = 32, rhd_large = 64, rhd_damaged = 128 };
+
+// Data types of format descriptors
+enum OdsDataType { dtype_text = 1, dtype_cstring = 2, dtype_varying = 3, dtype_short = 8,
+                   dtype_long = 9, dtype_quad = 10, dtype_real = 11, dtype_double = 12,
+                   dtype_sql_date = 14, dtype_sql_time = 15, dtype_timestamp = 16,
+                   dtype_blob = 17, dtype_array = 18, dtype_int64 = 19 };
+
+typedef struct __attribute__ ((packed)) {
+    quint8 pag_type;
+    quint8 pag_flags;
+    quint16 pag_checksum;
+    quint32 pag_generation;
+    quint32 pag_seqno;
+    quint32 pag_offset;
+} ods_page_t;
+
+typedef struct __attribute__ ((packed)) {
+    ods_page_t hdr_header;
+    quint16 hdr_page_size;
+    quint16 hdr_ods_version;    // Major version, 0x8000 flag means Firebird
+    quint32 hdr_PAGES;          // First pointer page of RDB$PAGES
+} ods_header_page_t;
+
+typedef struct __attribute__ ((packed)) {
+    ods_page_t ppg_header;
+    quint32 ppg_sequence;       // Sequence number in relation
+    quint32 ppg_next;           // Next pointer page in relation
+    quint16 ppg_count;          // Number of slots active
+    quint16 ppg_relation;
+    quint16 ppg_min_space;
+    quint16 ppg_max_space;
+    quint32 ppg_page[1];        // Data page vector
+} ods_pointer_page_t;
+
+typedef struct __attribute__ ((packed)) {
+    ods_page_t dpg_header;
+    quint32 dpg_sequence;       // Sequence number in relation
+    quint16 dpg_relation;
+    quint16 dpg_count;          // Number of record segments on page
+    struct {
+        quint16 dpg_offset;     // Offset of record fragment
+        quint16 dpg_length;     // Length of record fragment
+    } dpg_rpt[1];
+} ods_data_page_t;
+
+typedef struct __attribute__ ((packed)) {
+    quint32 rhd_transaction;
+    quint32 rhd_b_page;         // Back version page
+    quint16 rhd_b_line;         // Back version line
+    quint16 rhd_flags;
+    quint8 rhd_format;
+    quint8 rhd_data[1];
+} ods_record_header_t;
+
+// Header of the first fragment of fragmented record,
+// it is not packed in the engine, so there are holes
+typedef struct {
+    quint32 rhdf_transaction;
+    quint32 rhdf_b_page;
+    quint16 rhdf_b_line;
+    quint16 rhdf_flags;
+    quint8 rhdf_format;
+    quint32 rhdf_f_page;        // Next fragment page
+    quint16 rhdf_f_line;        // Next fragment line
+    quint8 rhdf_data[1];
+} ods_fragment_header_t;
+
+// BLOB header stored as record, not packed too
+typedef struct {
+    quint32 blh_lead_page;
+    quint32 blh_max_sequence;
+    quint16 blh_max_segment;
+    quint16 blh_flags;          // The same place as rhd_flags
+    quint8 blh_level;           // 0 - data follows, 1 - page vector, 2 - vector of page vectors
+    quint32 blh_count;
+    quint32 blh_length;
+    quint16 blh_sub_type;
+    quint8 blh_charset;
+    quint8 blh_unused;
+    quint32 blh_page[1];
+} ods_blob_header_t;
+
+typedef struct __attribute__ ((packed)) {
+    ods_page_t blp_header;
+    quint32 blp_lead_page;
+    quint32 blp_sequence;
+    quint16 blp_length;         // Bytes on page
+    quint16 blp_pad;
+    quint32 blp_page[1];        // Data or page numbers if level 2 pointer page
+} ods_blob_page_t;
+
+// On-disk format descriptor, RDB$FORMATS.RDB$DESCRIPTOR is array of them
+typedef struct {
+    quint8 dsc_dtype;
+    qint8 dsc_scale;
+    quint16 dsc_length;
+    qint16 dsc_sub_type;
+    quint16 dsc_flags;
+    quint32 dsc_offset;
+} ods_descriptor_t;
+
+#define ODS_RHD_SIZE offsetof(ods_record_header_t, rhd_data)
+#define ODS_RHDF_SIZE offsetof(ods_fragment_header_t, rhdf_data)
+#define ODS_BLH_SIZE offsetof(ods_blob_header_t, blh_page)
+#define ODS_BLP_SIZE offsetof(ods_blob_page_t, blp_page)
+#define ODS_DPG_SIZE sizeof(ods_data_page_t)
+
+/*************************************************/
+/************ ODS 11 structures END **************/
+/*************************************************/
+
+#endif // ODSREADER_H
@@ -0,0 +1,57 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "PoolFileWriter.h"
+#include <QtConcurrent>
+
+PoolFileWriter::PoolFileWriter()
+    : m_pendingBytes(0),
+    m_ok(true)
+{
+    // Threads mostly wait for file system, so there are more of them than cores
+    m_pool.setMaxThreadCount(THREAD_COUNT);
+}
+
+PoolFileWriter::~PoolFileWriter()
+{
+    finish();
+}
+
+bool PoolFileWriter::write(const QString &path, const QByteArray &data)
+{
+    while (!m_pending.isEmpty()
+           && ((m_pending.count() >= MAX_PENDING) || (m_pendingBytes >= MAX_PENDING_BYTES)))
+        waitOldest();
+
+    m_pending.enqueue({ QtConcurrent::run(&m_pool, [this, path, data]() { return writeFile(path, data); }),
+                        data.size() });
+    m_pendingBytes += data.size();
+
+    return true;
+}
+
+bool PoolFileWriter::finish()
+{
+    while (!m_pending.isEmpty())
+        waitOldest();
+
+    const bool ok = m_ok;
+    m_ok = true;
+
+    return ok;
+}
+
+void PoolFileWriter::waitOldest()
+{
+    QPair<QFuture<bool>, int> oldest = m_pending.dequeue();
+
+    if (!oldest.first.result())
+        m_ok = false;
+
+    m_pendingBytes -= oldest.second;
+}
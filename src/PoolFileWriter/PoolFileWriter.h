@@ -0,0 +1,45 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef POOLFILEWRITER_H
+#define POOLFILEWRITER_H
+
+#include "FileWriter/FileWriter.h"
+#include <QThreadPool>
+#include <QFuture>
+#include <QQueue>
+
+// Writes files with QFile on its own thread pool, so open/write/close
+// latency of many small files overlaps. Queue is bounded by number of
+// files and bytes, write() waits for the oldest files when it is full.
+class PoolFileWriter : public FileWriter
+{
+public:
+    enum {
+        THREAD_COUNT = 16,
+        MAX_PENDING = 1024,
+        MAX_PENDING_BYTES = 64 * 1024 * 1024
+    };
+
+    PoolFileWriter();
+    ~PoolFileWriter();
+
+    QString name() const override { return "pool"; }
+    bool write(const QString &path, const QByteArray &data) override;
+    bool finish() override;
+
+private:
+    QThreadPool m_pool;
+    QQueue<QPair<QFuture<bool>, int>> m_pending; // Write result and size
+    qint64 m_pendingBytes;
+    bool m_ok;
+
+    void waitOldest();
+};
+
+#endif // POOLFILEWRITER_H
@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "ProfileGridDialog.h"
+#include "ui_ProfileGridDialog.h"
+
+ProfileGridDialog::ProfileGridDialog(const QString &folderName,
+                                     RecordLoader *loader,
+                                     const QVector<TreeItem*> &items,
+                                     QWidget *parent)
+    : QDialog(parent),
+    ui(new Ui::ProfileGridDialog)
+{
+    ui->setupUi(this);
+
+    // Remove "?" button from window title
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    setWindowTitle("Profiles: " + folderName);
+
+    connect(ui->closeButton, &QPushButton::clicked, this, &QDialog::accept);
+
+    m_model = new ProfileGridModel(loader, items, this);
+    connect(m_model, &ProfileGridModel::loaded, this, &ProfileGridDialog::updateStatus);
+
+    // Name filter needs no profiles, so it doesn't load them all
+    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel->setSourceModel(m_model);
+    m_proxyModel->setFilterKeyColumn(0);
+    m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    connect(ui->filterEdit, &QLineEdit::textChanged, m_proxyModel, &QSortFilterProxyModel::setFilterWildcard);
+    connect(ui->filterEdit, &QLineEdit::textChanged, this, &ProfileGridDialog::updateStatus);
+
+    // Fixed row height and no resizing to contents: the view asks data of
+    // visible cells only
+    ui->gridView->setModel(m_proxyModel);
+    ui->gridView->setWordWrap(false);
+    ui->gridView->verticalHeader()->setDefaultSectionSize(
+        ui->gridView->verticalHeader()->fontMetrics().height());
+    ui->gridView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->gridView->horizontalHeader()->setDefaultSectionSize(150);
+    ui->gridView->horizontalHeader()->resizeSection(0, 250);
+
+    updateStatus();
+}
+
+ProfileGridDialog::~ProfileGridDialog()
+{
+    delete ui;
+}
+
+void ProfileGridDialog::updateStatus()
+{
+    QString status = QString("Files: %1 of %2, profiles loaded: %3, parameters: %4")
+                         .arg(m_proxyModel->rowCount())
+                         .arg(m_model->rowCount(QModelIndex()))
+                         .arg(m_model->loadedCount())
+                         .arg(m_model->columnCount(QModelIndex()) - ProfileGridModel::FIXED_COLUMNS);
+
+    if (!m_model->lastErrorMsg().isEmpty())
+        status += ", error: " + m_model->lastErrorMsg();
+
+    ui->statusLabel->setText(status);
+}
@@ -0,0 +1,41 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef PROFILEGRIDDIALOG_H
+#define PROFILEGRIDDIALOG_H
+
+#include <QDialog>
+#include <QSortFilterProxyModel>
+#include "ProfileGridModel/ProfileGridModel.h"
+
+namespace Ui {
+class ProfileGridDialog;
+}
+
+// Profiles of all files of a folder in one table, see ProfileGridModel
+class ProfileGridDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ProfileGridDialog(const QString &folderName,
+                               RecordLoader *loader,
+                               const QVector<TreeItem*> &items,
+                               QWidget *parent = nullptr);
+    ~ProfileGridDialog();
+
+private:
+    Ui::ProfileGridDialog *ui;
+    ProfileGridModel *m_model;
+    QSortFilterProxyModel *m_proxyModel;
+
+private slots:
+    void updateStatus();
+};
+
+#endif // PROFILEGRIDDIALOG_H
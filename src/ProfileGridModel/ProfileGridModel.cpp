@@ -0,0 +1,214 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "ProfileGridModel.h"
+#include <QtConcurrent>
+
+ProfileGridModel::ProfileGridModel(RecordLoader *loader, const QVector<TreeItem*> &items, QObject *parent)
+    : QAbstractTableModel{parent},
+    m_loader(loader),
+    m_loadedCount(0),
+    m_runningBatches(0),
+    m_timer(new QTimer(this))
+{
+    m_rows.reserve(items.count());
+    for (TreeItem *item : items)
+        m_rows.append({ item, false, false, QHash<int, QVariant>() });
+
+    // Requests of one paint are collected and served together
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &ProfileGridModel::fetchBatch);
+
+    connect(m_loader, &RecordLoader::profilesLoaded, this, &ProfileGridModel::profilesLoaded);
+}
+
+ProfileGridModel::~ProfileGridModel()
+{
+    for (auto it = m_tickets.cbegin(); it != m_tickets.cend(); ++it)
+        m_loader->cancel(it.key());
+
+    // Results of running batches are dropped with their watchers
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+int ProfileGridModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_rows.count();
+}
+
+int ProfileGridModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return FIXED_COLUMNS + m_parameters.count();
+}
+
+QVariant ProfileGridModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Row &row = m_rows.at(index.row());
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+            return row.item->name();
+        case 1:
+            return row.item->size();
+        case 2:
+            return TreeItem::DataTypeToText(row.item->type());
+        default:
+            break;
+        }
+
+        // Profile is requested when the row is shown for the first time
+        if (!row.requested) {
+            const_cast<Row&>(row).requested = true;
+            m_queue.append(index.row());
+            if (!m_timer->isActive())
+                m_timer->start(0);
+        }
+
+        if (!row.loaded)
+            return QVariant();
+
+        const QVariant value = row.values.value(index.column() - FIXED_COLUMNS);
+        return value.isValid() ? ProfileItem::valueToText(value) : QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole) {
+        if (index.column() == 1)
+            return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+        return QVariant(Qt::AlignLeft | Qt::AlignVCenter);
+    }
+
+    return QVariant();
+}
+
+QVariant ProfileGridModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((role != Qt::DisplayRole) || (orientation != Qt::Horizontal))
+        return QVariant();
+
+    switch (section) {
+    case 0:
+        return QString("Name");
+    case 1:
+        return QString("Size");
+    case 2:
+        return QString("Type");
+    default:
+        return m_parameters.value(section - FIXED_COLUMNS);
+    }
+}
+
+void ProfileGridModel::fetchBatch()
+{
+    if (m_queue.isEmpty())
+        return;
+
+    // Parser is busy, the queue is served when a batch is done
+    if (m_runningBatches >= MAX_BATCHES)
+        return;
+
+    // Rows requested last are visible now, rows scrolled away wait
+    QVector<int> rows;
+    QVector<int> ids;
+    while (!m_queue.isEmpty() && (rows.count() < BATCH_SIZE)) {
+        const int row = m_queue.takeLast();
+        rows.append(row);
+        ids.append(m_rows.at(row).item->id());
+    }
+
+    m_runningBatches++;
+    m_tickets.insert(m_loader->requestProfiles(ids), rows);
+
+    // The rest of the queue goes with the next batch
+    if (!m_queue.isEmpty())
+        m_timer->start(0);
+}
+
+void ProfileGridModel::profilesLoaded(int ticket, const QByteArrayList &profiles, const QString &errorMsg)
+{
+    // Loader is shared with file viewers of the database
+    if (!m_tickets.contains(ticket))
+        return;
+
+    const QVector<int> rows = m_tickets.take(ticket);
+
+    if (profiles.count() != rows.count()) {
+        m_lastErrorMsg = errorMsg.isEmpty() ? "Profile reading error!" : errorMsg;
+        QVector<Parsed> batch;
+        for (int row : rows)
+            batch.append({ row, QVector<ProfileItem>() });
+        m_runningBatches--;
+        batchParsed(batch);
+        fetchBatch();
+        return;
+    }
+
+    QFutureWatcher<QVector<Parsed>> *watcher = new QFutureWatcher<QVector<Parsed>>(this);
+    connect(watcher, &QFutureWatcher<QVector<Parsed>>::finished, this, [this, watcher]() {
+        m_runningBatches--;
+        batchParsed(watcher->result());
+        watcher->deleteLater();
+        fetchBatch();
+    });
+
+    watcher->setFuture(QtConcurrent::run(&m_pool, [rows, profiles]() {
+        QVector<Parsed> batch;
+        batch.reserve(rows.count());
+        for (int i = 0; i < rows.count(); i++)
+            batch.append({ rows.at(i), ProfileItem::fromRawData(profiles.at(i)) });
+        return batch;
+    }));
+}
+
+void ProfileGridModel::batchParsed(const QVector<Parsed> &batch)
+{
+    // Parameters met for the first time become new columns
+    QStringList newParameters;
+    for (const Parsed &parsed : batch)
+        for (const ProfileItem &item : parsed.items) {
+            const QString name = item.parameter.toUpper();
+            if (!m_parameterIndex.contains(name) && !newParameters.contains(name))
+                newParameters.append(name);
+        }
+
+    if (!newParameters.isEmpty()) {
+        const int first = FIXED_COLUMNS + m_parameters.count();
+        beginInsertColumns(QModelIndex(), first, first + newParameters.count() - 1);
+        for (const QString &name : qAsConst(newParameters)) {
+            m_parameterIndex.insert(name, m_parameters.count());
+            m_parameters.append(name);
+        }
+        endInsertColumns();
+    }
+
+    int top = m_rows.count(), bottom = -1;
+    for (const Parsed &parsed : batch) {
+        Row &row = m_rows[parsed.row];
+        for (const ProfileItem &item : parsed.items)
+            row.values.insert(m_parameterIndex.value(item.parameter.toUpper()), item.value);
+        row.loaded = true;
+        top = qMin(top, parsed.row);
+        bottom = qMax(bottom, parsed.row);
+    }
+
+    m_loadedCount += batch.count();
+
+    if ((bottom >= 0) && !m_parameters.isEmpty())
+        emit dataChanged(index(top, FIXED_COLUMNS), index(bottom, columnCount(QModelIndex()) - 1));
+    emit loaded(m_loadedCount, m_rows.count());
+}
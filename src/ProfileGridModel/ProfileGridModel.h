@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef PROFILEGRIDMODEL_H
+#define PROFILEGRIDMODEL_H
+
+#include <QAbstractTableModel>
+#include <QThreadPool>
+#include <QTimer>
+#include "RecordLoader/RecordLoader.h"
+#include "ProfileItem/ProfileItem.h"
+
+// Profiles of many files side by side: a row per file, a column per profile
+// parameter met so far. Profiles are loaded only for rows the view asks
+// data for: BLOBs are fetched in batches by the record loader of the
+// database, so a slow connection doesn't block the GUI, and parsed on
+// a thread pool. New parameters add columns as they are found.
+class ProfileGridModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum {
+        FIXED_COLUMNS = 3,  // Name, size, data type
+        BATCH_SIZE = 256,   // Profiles fetched per loader request
+        MAX_BATCHES = 4     // Batches loaded and parsed at the same time
+    };
+
+    explicit ProfileGridModel(RecordLoader *loader, const QVector<TreeItem*> &items, QObject *parent = nullptr);
+    ~ProfileGridModel();
+
+    int rowCount(const QModelIndex &parent) const override;
+    int columnCount(const QModelIndex &parent) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    int loadedCount() const { return m_loadedCount; }
+    // Error of the last failed batch, its rows stay empty
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+signals:
+    void loaded(int count, int total);
+
+private:
+    struct Row {
+        TreeItem *item;
+        bool requested;
+        bool loaded;
+        QHash<int, QVariant> values;    // Parameter index -> value
+    };
+
+    struct Parsed {
+        int row;
+        QVector<ProfileItem> items;
+    };
+
+    RecordLoader *m_loader;
+    QHash<int, QVector<int>> m_tickets;  // Rows of loader requests in progress
+    QString m_lastErrorMsg;
+    QVector<Row> m_rows;
+    QStringList m_parameters;           // Column names after fixed ones
+    QHash<QString, int> m_parameterIndex;
+    int m_loadedCount;
+    int m_runningBatches;
+    QThreadPool m_pool;
+
+    // Filled by data(), which is const: rows the view wants, latest last
+    mutable QVector<int> m_queue;
+    QTimer *m_timer;
+
+    void fetchBatch();
+    void profilesLoaded(int ticket, const QByteArrayList &profiles, const QString &errorMsg);
+    void batchParsed(const QVector<Parsed> &batch);
+};
+
+#endif // PROFILEGRIDMODEL_H
@@ -7,6 +7,7 @@
 ****************************************************************************/
 
 #include "ProfileItem.h"
+#include "Tracer/Tracer.h"
 
 static QDateTime fromTDateTime(const double &tDateTime)
 {
@@ -173,7 +174,26 @@ static int loadRawData(QVector<ProfileItem> *vector, const char *buffer, int len
 
 QVector<ProfileItem> ProfileItem::fromRawData(const QByteArray &data)
 {
+    TRACE_SCOPE("profile parse");
+
     QVector<ProfileItem> result;
     loadRawData(&result, data.data(), data.size());
     return result;
 }
+
+int ProfileItem::parse(const QByteArray &data, QVector<ProfileItem> *items)
+{
+    TRACE_SCOPE("profile parse");
+
+    return loadRawData(items, data.data(), data.size());
+}
+
+QString ProfileItem::valueToText(const QVariant &value)
+{
+    if (value.type() == QVariant::UInt)
+        return QString("%1 (0x%2)")
+            .arg(QString::number(value.toUInt()))
+            .arg(value.toUInt(), 8, 16, QChar('0'));
+
+    return value.toString();
+}
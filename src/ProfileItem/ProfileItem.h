@@ -19,6 +19,10 @@ public:
     QVariant value;
 
     static QVector<ProfileItem> fromRawData(const QByteArray &data);
+    // Returns number of items declared in the header or negative error code
+    static int parse(const QByteArray &data, QVector<ProfileItem> *items);
+    // Value as shown to the user, integers also in hex
+    static QString valueToText(const QVariant &value);
 };
 
 /*************************************************/
@@ -41,12 +41,7 @@ QVariant ProfileModel::data(const QModelIndex &index, int role) const
         case 0:
             return parameter;
         case 1:
-            if (value.type() == QVariant::UInt)
-                return QString("%1 (0x%2)")
-                    .arg(QString::number(value.toUInt()))
-                    .arg(value.toUInt(), 8, 16, QChar('0'));
-            else
-                return value;
+            return ProfileItem::valueToText(value);
         default:
             return QString();
         }
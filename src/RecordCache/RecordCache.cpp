@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "RecordCache.h"
+
+struct RecordKey {
+    int database;
+    int record;
+    int part;
+};
+
+static bool operator==(const RecordKey &a, const RecordKey &b)
+{
+    return (a.database == b.database) && (a.record == b.record) && (a.part == b.part);
+}
+
+static uint qHash(const RecordKey &key, uint seed = 0)
+{
+    return qHash(qMakePair(qMakePair(key.database, key.record), key.part), seed);
+}
+
+static QMutex mutex;
+static QAtomicInt lastDatabaseId;
+static QCache<RecordKey, QByteArray> cache(RecordCache::DEFAULT_BUDGET * 1024);  // Cost is in KiB
+
+int RecordCache::newDatabaseId()
+{
+    return lastDatabaseId.fetchAndAddRelaxed(1) + 1;
+}
+
+QByteArray RecordCache::find(int database, int record, int part)
+{
+    QMutexLocker locker(&mutex);
+
+    // Copy is implicitly shared, the entry may be dropped by another thread
+    const QByteArray *data = cache.object({ database, record, part });
+    return data ? *data : QByteArray();
+}
+
+void RecordCache::insert(int database, int record, int part, const QByteArray &data)
+{
+    QMutexLocker locker(&mutex);
+    cache.insert({ database, record, part }, new QByteArray(data), qMax(1, data.size() / 1024));
+}
+
+void RecordCache::remove(int database)
+{
+    QMutexLocker locker(&mutex);
+
+    const QList<RecordKey> keys = cache.keys();
+    for (const RecordKey &key : keys)
+        if (key.database == database)
+            cache.remove(key);
+}
+
+void RecordCache::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    cache.setMaxCost(qBound<qint64>(1, bytes / 1024, INT_MAX));
+}
+
+qint64 RecordCache::budget()
+{
+    QMutexLocker locker(&mutex);
+    return (qint64)cache.maxCost() * 1024;
+}
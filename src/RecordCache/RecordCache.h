@@ -0,0 +1,38 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef RECORDCACHE_H
+#define RECORDCACHE_H
+
+#include <QtCore>
+
+// Inflated data shared by all open databases. Entries are keyed by
+// database, record ID and part of the record (page number), total size
+// of the cache is limited by a global memory budget. Thread safe.
+class RecordCache
+{
+public:
+    enum {
+        DEFAULT_BUDGET = 256    // MiB
+    };
+
+    // Unique ID of a database connection, used as the first part of keys
+    static int newDatabaseId();
+
+    // Null array if the entry is not cached
+    static QByteArray find(int database, int record, int part);
+    static void insert(int database, int record, int part, const QByteArray &data);
+    // Drops all entries of the database
+    static void remove(int database);
+
+    // Memory budget in bytes, least recently used entries are dropped to fit
+    static void setBudget(qint64 bytes);
+    static qint64 budget();
+};
+
+#endif // RECORDCACHE_H
@@ -0,0 +1,255 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "RecordDevice.h"
+#include "RecordCache/RecordCache.h"
+#include <QtEndian>
+#include <QDebug>
+
+RecordDevice::RecordDevice(const QByteArray &blob,
+                           QSharedPointer<InflateIndex> index,
+                           int database,
+                           int record,
+                           QObject *parent)
+    : QIODevice{parent},
+    m_blob(blob),
+    m_size(0),
+    m_valid(false),
+    m_index(index),
+    m_database(database),
+    m_record(record),
+    m_streamReady(false),
+    m_streamEnd(false),
+    m_streamIn(0),
+    m_streamOut(0)
+{
+    memset(&m_stream, 0, sizeof(m_stream));
+
+    if (m_blob.size() < (int)sizeof(quint32)) {
+        qDebug() << "BLOB size too small!";
+        return;
+    }
+
+    m_size = qFromLittleEndian<quint32>(m_blob.constData());
+    m_valid = true;
+}
+
+RecordDevice::~RecordDevice()
+{
+    if (m_streamReady)
+        inflateEnd(&m_stream);
+}
+
+bool RecordDevice::open(OpenMode mode)
+{
+    if (!m_valid || (mode & WriteOnly))
+        return false;
+
+    return QIODevice::open(mode);
+}
+
+qint64 RecordDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 done = 0;
+    qint64 offset = pos();
+
+    while ((done < maxSize) && (offset < m_size)) {
+        const QByteArray p = page(offset / PAGE_SIZE);
+        if (p.isNull()) {
+            emit readFailed(offset, errorString());
+            return done ? done : -1;
+        }
+
+        const int pageOffset = offset % PAGE_SIZE;
+        const qint64 count = qMin<qint64>(maxSize - done, p.size() - pageOffset);
+        if (count <= 0) {
+            // Stream ended before declared size
+            setErrorString("Unexpected end of compressed data");
+            emit readFailed(offset, errorString());
+            return done ? done : -1;
+        }
+
+        memcpy(data + done, p.constData() + pageOffset, count);
+        done += count;
+        offset += count;
+    }
+
+    return done;
+}
+
+qint64 RecordDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+QByteArray RecordDevice::page(int index)
+{
+    QByteArray p = RecordCache::find(m_database, m_record, index);
+    if (!p.isNull())
+        return p;
+
+    const qint64 offset = (qint64)index * PAGE_SIZE;
+
+    if (!seekStream(offset))
+        return QByteArray();
+
+    // Pages between current stream position and requested one are cached too
+    while (m_streamOut <= offset) {
+        p = QByteArray(qMin<qint64>(m_size - m_streamOut, PAGE_SIZE), Qt::Uninitialized);
+        const int pageIndex = m_streamOut / PAGE_SIZE;
+        const qint64 count = inflateData(p.data(), p.size());
+
+        if (count <= 0) {
+            if (count == 0)
+                setErrorString("Unexpected end of compressed data");
+            return QByteArray();
+        }
+
+        p.truncate(count);
+        RecordCache::insert(m_database, m_record, pageIndex, p);
+    }
+
+    return p;
+}
+
+bool RecordDevice::seekStream(qint64 offset)
+{
+    const InflateIndex::Point *point = m_index ? m_index->find(offset) : nullptr;
+
+    // Deflate stream can't be read backwards, so start it over from
+    // the nearest checkpoint or from the beginning
+    if (!m_streamReady || (offset < m_streamOut)) {
+        if (!(point ? resume(point) : rewind()))
+            return false;
+    } else if (point && (point->out > m_streamOut)) {
+        if (!resume(point))
+            return false;
+    }
+
+    // Checkpoints are not page aligned
+    const qint64 boundary = (m_streamOut + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    if (boundary > m_streamOut) {
+        QByteArray skip(boundary - m_streamOut, Qt::Uninitialized);
+        const qint64 count = inflateData(skip.data(), skip.size());
+        if (count != skip.size()) {
+            if (count >= 0)
+                setErrorString("Unexpected end of compressed data");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+qint64 RecordDevice::inflateData(char *data, qint64 maxSize)
+{
+    m_stream.next_out = (Bytef *)data;
+    m_stream.avail_out = maxSize;
+
+    while ((m_stream.avail_out > 0) && !m_streamEnd) {
+        const uInt availIn = m_stream.avail_in;
+        const uInt availOut = m_stream.avail_out;
+
+        // Z_BLOCK stops at deflate block boundaries, where checkpoints are possible
+        const int err = inflate(&m_stream, Z_BLOCK);
+
+        m_streamIn += availIn - m_stream.avail_in;
+        m_streamOut += availOut - m_stream.avail_out;
+
+        if (err == Z_STREAM_END) {
+            m_streamEnd = true;
+            break;
+        }
+
+        if (err != Z_OK) {
+            streamError();
+            return -1;
+        }
+
+        // End of block, but not of the last one
+        const bool boundary = (m_stream.data_type & 128) && !(m_stream.data_type & 64);
+
+        if (m_index && boundary && m_index->needPoint(m_streamOut)) {
+            InflateIndex::Point point;
+            point.out = m_streamOut;
+            point.in = m_streamIn;
+            point.bits = m_stream.data_type & 7;
+            point.window.resize(InflateIndex::WINDOW_SIZE);
+            uInt length = point.window.size();
+            inflateGetDictionary(&m_stream, (Bytef *)point.window.data(), &length);
+            point.window.truncate(length);
+            m_index->append(point);
+        }
+    }
+
+    return maxSize - m_stream.avail_out;
+}
+
+bool RecordDevice::rewind()
+{
+    if (m_streamReady)
+        inflateEnd(&m_stream);
+
+    memset(&m_stream, 0, sizeof(m_stream));
+    m_stream.next_in = (Bytef *)m_blob.constData() + sizeof(quint32);
+    m_stream.avail_in = m_blob.size() - sizeof(quint32);
+
+    m_streamReady = (inflateInit(&m_stream) == Z_OK);
+    m_streamEnd = false;
+    m_streamIn = 0;
+    m_streamOut = 0;
+
+    if (!m_streamReady)
+        streamError();
+
+    return m_streamReady;
+}
+
+bool RecordDevice::resume(const InflateIndex::Point *point)
+{
+    if (m_streamReady)
+        inflateEnd(&m_stream);
+
+    const Bytef *in = (const Bytef *)m_blob.constData() + sizeof(quint32);
+
+    // Raw deflate, zlib header is behind
+    memset(&m_stream, 0, sizeof(m_stream));
+    m_streamReady = (inflateInit2(&m_stream, -MAX_WBITS) == Z_OK);
+    m_streamEnd = false;
+
+    if (!m_streamReady) {
+        streamError();
+        return false;
+    }
+
+    // Checkpoint may be in the middle of a byte
+    if (point->bits)
+        inflatePrime(&m_stream, point->bits, in[point->in - 1] >> (8 - point->bits));
+
+    m_stream.next_in = (Bytef *)in + point->in;
+    m_stream.avail_in = m_blob.size() - sizeof(quint32) - point->in;
+    inflateSetDictionary(&m_stream, (const Bytef *)point->window.constData(), point->window.size());
+
+    m_streamIn = point->in;
+    m_streamOut = point->out;
+
+    return true;
+}
+
+void RecordDevice::streamError()
+{
+    qDebug() << "BLOB uncompress error!";
+    setErrorString(m_stream.msg ? m_stream.msg : "BLOB uncompress error");
+
+    if (m_streamReady)
+        inflateEnd(&m_stream);
+
+    m_streamReady = false;
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef RECORDDEVICE_H
+#define RECORDDEVICE_H
+
+#include <QIODevice>
+#include <QSharedPointer>
+#include <QtZlib/zlib.h>
+#include "InflateIndex/InflateIndex.h"
+
+// Read-only random access device over compressed DATA BLOB. Data is inflated
+// page by page on demand, pages are kept in RecordCache shared by all devices.
+class RecordDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    enum {
+        PAGE_SIZE = 0x10000     // Uncompressed page size, 64 KiB
+    };
+
+    // Compressed BLOB is 32-bit little-endian uncompressed length
+    // followed by zlib stream. Checkpoints are added to the index while
+    // inflating and used to jump over the data already seen. Database and
+    // record IDs are the cache key, see RecordCache.
+    explicit RecordDevice(const QByteArray &blob,
+                          QSharedPointer<InflateIndex> index,
+                          int database,
+                          int record,
+                          QObject *parent = nullptr);
+    ~RecordDevice();
+
+    // False if BLOB header is broken
+    bool isValid() const { return m_valid; }
+
+    bool open(OpenMode mode) override;
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_size; }
+
+signals:
+    // Size is taken from the length prefix, so a damaged or short stream is
+    // found only when the data is read. QHexEdit ignores read errors, the
+    // viewer learns about them from this signal.
+    void readFailed(qint64 offset, const QString &errorMsg);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QByteArray m_blob;
+    qint64 m_size;
+    bool m_valid;
+    QSharedPointer<InflateIndex> m_index;
+    int m_database;
+    int m_record;
+    z_stream m_stream;
+    bool m_streamReady;
+    bool m_streamEnd;
+    qint64 m_streamIn;      // Compressed bytes consumed
+    qint64 m_streamOut;     // Uncompressed bytes produced
+
+    QByteArray page(int index);
+    bool seekStream(qint64 offset);
+    qint64 inflateData(char *data, qint64 maxSize);
+    bool rewind();
+    bool resume(const InflateIndex::Point *point);
+    void streamError();
+};
+
+#endif // RECORDDEVICE_H
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "RecordDiff.h"
+#include "Tracer/Tracer.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RECORDDIFF_SSE2
+#endif
+
+QVector<RecordDiff::Range> RecordDiff::compare(const QByteArray &a, const QByteArray &b, qint64 mergeGap)
+{
+    TRACE_SCOPE("record diff");
+
+    QVector<Range> ranges;
+    const qint64 common = qMin(a.size(), b.size());
+    const char *pa = a.constData();
+    const char *pb = b.constData();
+    qint64 pos = 0;
+
+    while (pos < common) {
+        pos += firstDifference(pa + pos, pb + pos, common - pos);
+        if (pos >= common)
+            break;
+
+        const qint64 end = pos + firstEqual(pa + pos, pb + pos, common - pos);
+
+        if (!ranges.isEmpty() && (pos - (ranges.last().offset + ranges.last().length) < mergeGap))
+            ranges.last().length = end - ranges.last().offset;
+        else
+            ranges.append({ pos, end - pos });
+
+        pos = end;
+    }
+
+    // Tail of the longer record
+    const qint64 longest = qMax(a.size(), b.size());
+    if (longest > common) {
+        if (!ranges.isEmpty() && (common - (ranges.last().offset + ranges.last().length) < qMax<qint64>(mergeGap, 1)))
+            ranges.last().length = longest - ranges.last().offset;
+        else
+            ranges.append({ common, longest - common });
+    }
+
+    Tracer::count("bytes compared", common);
+    return ranges;
+}
+
+qint64 RecordDiff::length(const QVector<Range> &ranges)
+{
+    qint64 total = 0;
+    for (const Range &range : ranges)
+        total += range.length;
+    return total;
+}
+
+qint64 RecordDiff::firstDifference(const char *a, const char *b, qint64 size)
+{
+    qint64 i = 0;
+
+#ifdef RECORDDIFF_SSE2
+    for (; i + 16 <= size; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        const uint equal = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (equal != 0xFFFF)
+            return i + qCountTrailingZeroBits(~equal);
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        quint64 x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        if (x != y)
+            break;  // The byte is found below
+    }
+#endif
+
+    for (; i < size; i++)
+        if (a[i] != b[i])
+            return i;
+
+    return size;
+}
+
+qint64 RecordDiff::firstEqual(const char *a, const char *b, qint64 size)
+{
+    qint64 i = 0;
+
+#ifdef RECORDDIFF_SSE2
+    for (; i + 16 <= size; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        const uint equal = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (equal)
+            return i + qCountTrailingZeroBits(equal);
+    }
+#endif
+
+    for (; i < size; i++)
+        if (a[i] == b[i])
+            return i;
+
+    return size;
+}
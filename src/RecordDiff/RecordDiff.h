@@ -0,0 +1,40 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef RECORDDIFF_H
+#define RECORDDIFF_H
+
+#include <QtCore>
+
+// Byte by byte comparison of two records. Equal data is skipped 16 bytes
+// at a time with SSE2 (8 bytes with plain 64-bit words elsewhere), so
+// multi-megabyte dumps are compared at memory bandwidth.
+class RecordDiff
+{
+public:
+    // Differing bytes [offset, offset + length)
+    struct Range {
+        qint64 offset;
+        qint64 length;
+    };
+
+    // Differing ranges in offset order. Bytes past the end of the shorter
+    // record are different. Ranges separated by less than mergeGap equal
+    // bytes are reported as one.
+    static QVector<Range> compare(const QByteArray &a, const QByteArray &b, qint64 mergeGap = 0);
+
+    // Total number of differing bytes
+    static qint64 length(const QVector<Range> &ranges);
+
+    // Offset of the first differing (or equal) byte from the start of both
+    // buffers, size if there is none
+    static qint64 firstDifference(const char *a, const char *b, qint64 size);
+    static qint64 firstEqual(const char *a, const char *b, qint64 size);
+};
+
+#endif // RECORDDIFF_H
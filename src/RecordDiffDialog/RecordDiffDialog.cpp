@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "RecordDiffDialog.h"
+#include "ui_RecordDiffDialog.h"
+#include <QScrollBar>
+
+RecordDiffDialog::RecordDiffDialog(const QString &oldName,
+                                   const QByteArray &oldData,
+                                   const QString &newName,
+                                   const QByteArray &newData,
+                                   QWidget *parent)
+    : QDialog(parent),
+    ui(new Ui::RecordDiffDialog)
+{
+    ui->setupUi(this);
+
+    // Remove "?" button from window title
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    setWindowTitle(QString("Compare: %1 - %2").arg(oldName).arg(newName));
+
+    connect(ui->previousButton, &QPushButton::clicked, this, &RecordDiffDialog::previous);
+    connect(ui->nextButton, &QPushButton::clicked, this, &RecordDiffDialog::next);
+    connect(ui->closeButton, &QPushButton::clicked, this, &QDialog::accept);
+
+    ui->oldLabel->setText(QString("%1 (%2 bytes)").arg(oldName).arg(oldData.size()));
+    ui->newLabel->setText(QString("%1 (%2 bytes)").arg(newName).arg(newData.size()));
+
+    m_oldHexEdit = createHexEdit(oldData);
+    m_newHexEdit = createHexEdit(newData);
+    ui->oldLayout->addWidget(m_oldHexEdit);
+    ui->newLayout->addWidget(m_newHexEdit);
+
+    // Both views show the same offset
+    syncScrolling(m_oldHexEdit, m_newHexEdit);
+    syncScrolling(m_newHexEdit, m_oldHexEdit);
+
+    m_ranges = RecordDiff::compare(oldData, newData, MERGE_GAP);
+
+    // Range list is filled in one go
+    QStringList items;
+    items.reserve(m_ranges.count());
+    for (const RecordDiff::Range &range : qAsConst(m_ranges))
+        items.append(QString("%1  %2 bytes")
+                         .arg(range.offset, 8, 16, QChar('0'))
+                         .arg(range.length));
+    ui->rangeList->addItems(items);
+    connect(ui->rangeList, &QListWidget::currentRowChanged, this, &RecordDiffDialog::showRange);
+
+    if (m_ranges.isEmpty())
+        ui->summaryLabel->setText("Records are equal.");
+    else
+        ui->summaryLabel->setText(QString("Differences: %1, %2 bytes differ.")
+                                      .arg(m_ranges.count())
+                                      .arg(RecordDiff::length(m_ranges)));
+
+    ui->splitter->setSizes({ width() * 16 / 100, width() * 42 / 100, width() * 42 / 100 });
+
+    if (m_ranges.isEmpty())
+        showRange(-1);
+    else
+        ui->rangeList->setCurrentRow(0);
+}
+
+RecordDiffDialog::~RecordDiffDialog()
+{
+    delete ui;
+}
+
+QHexEdit *RecordDiffDialog::createHexEdit(const QByteArray &data)
+{
+    // Monospace font definition
+    QFont mainFont = QApplication::font();
+    QFont monoFont = QFont("Courier", mainFont.pointSize());
+
+    QHexEdit *hexEdit = new QHexEdit;
+    hexEdit->setReadOnly(true);
+    hexEdit->setFont(monoFont);
+    hexEdit->setData(data);
+
+    return hexEdit;
+}
+
+void RecordDiffDialog::syncScrolling(QHexEdit *from, QHexEdit *to)
+{
+    // Setting the same value does not emit the signal again
+    connect(from->verticalScrollBar(), &QScrollBar::valueChanged,
+            to->verticalScrollBar(), &QScrollBar::setValue);
+    connect(from->horizontalScrollBar(), &QScrollBar::valueChanged,
+            to->horizontalScrollBar(), &QScrollBar::setValue);
+}
+
+void RecordDiffDialog::showRange(int index)
+{
+    ui->previousButton->setEnabled(index > 0);
+    ui->nextButton->setEnabled((index >= 0) && (index < m_ranges.count() - 1));
+
+    if ((index < 0) || (index >= m_ranges.count()))
+        return;
+
+    // Cursor position is in nibbles
+    const qint64 offset = m_ranges.at(index).offset;
+    for (QHexEdit *hexEdit : { m_oldHexEdit, m_newHexEdit }) {
+        hexEdit->setCursorPosition(offset * 2);
+        hexEdit->ensureVisible();
+    }
+}
+
+void RecordDiffDialog::previous()
+{
+    if (ui->rangeList->currentRow() > 0)
+        ui->rangeList->setCurrentRow(ui->rangeList->currentRow() - 1);
+}
+
+void RecordDiffDialog::next()
+{
+    if (ui->rangeList->currentRow() < m_ranges.count() - 1)
+        ui->rangeList->setCurrentRow(ui->rangeList->currentRow() + 1);
+}
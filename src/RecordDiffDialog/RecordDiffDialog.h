@@ -0,0 +1,52 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef RECORDDIFFDIALOG_H
+#define RECORDDIFFDIALOG_H
+
+#include <QDialog>
+#include "qhexedit.h"
+#include "RecordDiff/RecordDiff.h"
+
+namespace Ui {
+class RecordDiffDialog;
+}
+
+// Two records in synchronised hex views with navigation between differences
+class RecordDiffDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    enum {
+        MERGE_GAP = 16  // Differences closer than a hex view row are shown as one
+    };
+
+    explicit RecordDiffDialog(const QString &oldName,
+                              const QByteArray &oldData,
+                              const QString &newName,
+                              const QByteArray &newData,
+                              QWidget *parent = nullptr);
+    ~RecordDiffDialog();
+
+private:
+    Ui::RecordDiffDialog *ui;
+    QHexEdit *m_oldHexEdit;
+    QHexEdit *m_newHexEdit;
+    QVector<RecordDiff::Range> m_ranges;
+
+    QHexEdit *createHexEdit(const QByteArray &data);
+    void syncScrolling(QHexEdit *from, QHexEdit *to);
+
+private slots:
+    void showRange(int index);
+    void previous();
+    void next();
+};
+
+#endif // RECORDDIFFDIALOG_H
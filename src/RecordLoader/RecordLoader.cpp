@@ -0,0 +1,145 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "RecordLoader.h"
+#include "Tracer/Tracer.h"
+
+RecordLoader::RecordLoader(const SqlCore *settings, const QString &path, QObject *parent)
+    : QObject{parent},
+    m_context(new QObject),
+    m_sqlCore(new SqlCore),
+    m_nextTicket(0)
+{
+    m_sqlCore->copySettings(settings);
+    m_sqlCore->openLater(path);
+
+    m_context->moveToThread(&m_thread);
+    m_sqlCore->moveToThread(&m_thread);
+
+    // Connection must be closed by the thread it was used in
+    connect(&m_thread, &QThread::finished, m_context, [this]() {
+        delete m_sqlCore;
+        m_sqlCore = nullptr;
+    }, Qt::DirectConnection);
+
+    m_thread.setObjectName("RecordLoader");
+    m_thread.start();
+}
+
+RecordLoader::~RecordLoader()
+{
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+}
+
+int RecordLoader::request(int recordId)
+{
+    const int ticket = m_nextTicket++;
+
+    m_mutex.lock();
+    m_pending.insert(ticket);
+    m_mutex.unlock();
+
+    QMetaObject::invokeMethod(m_context, [this, ticket, recordId]() {
+        load(ticket, recordId);
+    }, Qt::QueuedConnection);
+
+    return ticket;
+}
+
+int RecordLoader::requestProfiles(const QVector<int> &recordIds)
+{
+    const int ticket = m_nextTicket++;
+
+    m_mutex.lock();
+    m_pending.insert(ticket);
+    m_mutex.unlock();
+
+    QMetaObject::invokeMethod(m_context, [this, ticket, recordIds]() {
+        loadProfiles(ticket, recordIds);
+    }, Qt::QueuedConnection);
+
+    return ticket;
+}
+
+void RecordLoader::cancel(int ticket)
+{
+    // Served tickets are not pending, nothing is left behind for them
+    QMutexLocker locker(&m_mutex);
+    m_pending.remove(ticket);
+}
+
+bool RecordLoader::isPending(int ticket)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.contains(ticket);
+}
+
+bool RecordLoader::takePending(int ticket)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.remove(ticket);
+}
+
+void RecordLoader::load(int ticket, int recordId)
+{
+    if (!isPending(ticket))
+        return;
+
+    TRACE_SCOPE("load record");
+
+    if (!m_sqlCore->openPending()) {
+        if (takePending(ticket))
+            emit loaded(ticket, QByteArray(), QByteArray(), m_sqlCore->lastErrorMsg());
+        return;
+    }
+
+    StorageBackend *backend = m_sqlCore->backend();
+
+    // Native reader may return mapped file data, it is valid until this connection is closed
+    QByteArray data = backend->blob(recordId, "DATA");
+    QByteArray profile = backend->blob(recordId, "PROFILE");
+    data.detach();
+    profile.detach();
+
+    // Canceled while loading
+    if (!takePending(ticket))
+        return;
+
+    emit loaded(ticket, data, profile, data.isEmpty() ? backend->lastErrorMsg() : QString());
+}
+
+void RecordLoader::loadProfiles(int ticket, const QVector<int> &recordIds)
+{
+    if (!isPending(ticket))
+        return;
+
+    TRACE_SCOPE("load profiles");
+
+    if (!m_sqlCore->openPending()) {
+        if (takePending(ticket))
+            emit profilesLoaded(ticket, QByteArrayList(), m_sqlCore->lastErrorMsg());
+        return;
+    }
+
+    StorageBackend *backend = m_sqlCore->backend();
+
+    QByteArrayList profiles;
+    profiles.reserve(recordIds.count());
+    for (int id : recordIds) {
+        QByteArray profile = backend->blob(id, "PROFILE");
+        profile.detach(); // Mapped file data, as above
+        profiles.append(profile);
+    }
+
+    if (!takePending(ticket))
+        return;
+
+    emit profilesLoaded(ticket, profiles, QString());
+}
@@ -0,0 +1,59 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef RECORDLOADER_H
+#define RECORDLOADER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QSet>
+#include <QByteArrayList>
+#include "SqlCore/SqlCore.h"
+
+// Fetches DATA and PROFILE BLOBs of one database on its own thread with
+// its own connection, so a slow record doesn't block the GUI. Requests are
+// served in order, canceled ones are skipped if they are not started yet.
+class RecordLoader : public QObject
+{
+    Q_OBJECT
+public:
+    // Connection settings are copied from the core, the database is opened
+    // on the first request
+    explicit RecordLoader(const SqlCore *settings, const QString &path, QObject *parent = nullptr);
+    // Waits for the request in progress
+    ~RecordLoader();
+
+    // Returns ticket of the request, loaded() comes with it
+    int request(int recordId);
+    // PROFILE BLOBs only, profilesLoaded() comes with the ticket
+    int requestProfiles(const QVector<int> &recordIds);
+    // Result of the request is not needed anymore
+    void cancel(int ticket);
+
+signals:
+    // Emitted from the loader thread, connections are queued
+    void loaded(int ticket, const QByteArray &data, const QByteArray &profile, const QString &errorMsg);
+    void profilesLoaded(int ticket, const QByteArrayList &profiles, const QString &errorMsg);
+
+private:
+    QThread m_thread;
+    QObject *m_context;     // Lives in the thread, requests are its events
+    SqlCore *m_sqlCore;     // Used by the thread only
+    int m_nextTicket;
+    QMutex m_mutex;
+    QSet<int> m_pending;    // Tickets neither served nor canceled
+
+    bool isPending(int ticket);
+    // Ticket is served, returns false if it was canceled
+    bool takePending(int ticket);
+    void load(int ticket, int recordId);
+    void loadProfiles(int ticket, const QVector<int> &recordIds);
+};
+
+#endif // RECORDLOADER_H
@@ -0,0 +1,402 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Repacker.h"
+#include <QtEndian>
+#include <QtZlib/zlib.h>
+#include "BatchPipeline/BatchPipeline.h"
+#include "InflateContext/InflateContext.h"
+#include "SqliteConverter/SqliteConverter.h"
+#include "Tracer/Tracer.h"
+
+static const char *connectionName = "Repacker";
+
+// Firebird counterpart of SqliteConverter::schema(), indices are the same
+static const char *firebirdSchema[] = {
+    "CREATE TABLE FOLDERS ("
+    " ID INTEGER NOT NULL PRIMARY KEY,"
+    " PARENTID INTEGER,"
+    " FOLDERNAME VARCHAR(255));",
+
+    "CREATE TABLE DATA ("
+    " ID INTEGER NOT NULL PRIMARY KEY,"
+    " FOLDERID INTEGER,"
+    " MODULENAME VARCHAR(255),"
+    " KIND INTEGER,"
+    " DATASIZE INTEGER,"
+    " CREATEDDATE TIMESTAMP,"
+    " DATA BLOB SUB_TYPE 0,"
+    " PROFILE BLOB SUB_TYPE 0);"
+};
+
+// isql string literal
+static QString quoted(const QString &value)
+{
+    return "'" + QString(value).replace("'", "''") + "'";
+}
+
+struct RepackJob {
+    FileRecord file;
+    QByteArray data;
+    QByteArray profile;
+    int level;
+    bool repacked;
+};
+
+static void repackJob(RepackJob &job)
+{
+    job.repacked = false;
+
+    // Damaged BLOB is copied as is, so the new database has the same damage
+    QByteArray raw;
+    if (!InflateContext::local()->inflateBlob(job.data, &raw)
+        || ((quint32)raw.size() != qFromLittleEndian<quint32>(job.data.constData())))
+        return;
+
+    const QByteArray packed = Repacker::packBlob(raw, job.level);
+    if (!packed.isEmpty() && (packed.size() < job.data.size())) {
+        job.data = packed;
+        job.repacked = true;
+    }
+}
+
+Repacker::Repacker(SqlCore *sqlCore, QObject *parent)
+    : QObject{parent},
+    m_sqlCore(sqlCore),
+    m_backend(nullptr),
+    m_level(DEFAULT_LEVEL),
+    m_user(qEnvironmentVariable("ISC_USER", "SYSDBA")),
+    m_password(qEnvironmentVariable("ISC_PASSWORD", "masterkey")),
+    m_canceled(false),
+    m_writtenCount(0),
+    m_repackedCount(0),
+    m_inputBytes(0),
+    m_outputBytes(0)
+{
+
+}
+
+void Repacker::setCredentials(const QString &user, const QString &password)
+{
+    m_user = user;
+    m_password = password;
+}
+
+QByteArray Repacker::packBlob(const QByteArray &data, int level)
+{
+    TRACE_SCOPE("deflate");
+
+    uLongf length = compressBound(data.size());
+
+    QByteArray out(sizeof(quint32) + length, Qt::Uninitialized);
+    qToLittleEndian<quint32>(data.size(), out.data());
+
+    int err = compress2((uchar *)out.data() + sizeof(quint32),
+                        &length,
+                        (const uchar *)data.constData(),
+                        data.size(),
+                        level);
+    if (err != Z_OK)
+        return QByteArray();
+
+    out.resize(sizeof(quint32) + length);
+    return out;
+}
+
+bool Repacker::repack(const QString &path, const QList<TreeItem*> &items)
+{
+    m_canceled = false;
+    m_lastErrorMsg.clear();
+    m_writtenCount = 0;
+    m_repackedCount = 0;
+    m_inputBytes = 0;
+    m_outputBytes = 0;
+
+    m_backend = m_sqlCore->backend();
+    if (!m_backend) {
+        m_lastErrorMsg = m_sqlCore->lastErrorMsg();
+        return false;
+    }
+
+    if (!select(items))
+        return false;
+
+    const bool sqlite = path.endsWith(".sqlite", Qt::CaseInsensitive);
+
+    // Result appears under final name only when repacking is completed
+    const QString partPath = path + ".part";
+    QFile::remove(partPath);
+
+    if (!sqlite && !createDatabase(partPath)) {
+        QFile::remove(partPath);
+        return false;
+    }
+
+    bool ok = true;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(sqlite ? "QSQLITE" : "QIBASE", connectionName);
+        db.setDatabaseName(QFileInfo(partPath).absoluteFilePath());
+        if (!sqlite) {
+            db.setUserName(m_user);
+            db.setPassword(m_password);
+        }
+
+        if (!db.open()) {
+            m_lastErrorMsg = db.lastError().databaseText();
+            ok = false;
+        }
+
+        if (ok)
+            ok = write(db, sqlite);
+
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (ok) {
+        QFile::remove(path);
+        if (!QFile::rename(partPath, path)) {
+            m_lastErrorMsg = "Can't rename " + partPath;
+            ok = false;
+        }
+    }
+
+    if (!ok)
+        QFile::remove(partPath);
+
+    return ok;
+}
+
+bool Repacker::select(const QList<TreeItem*> &items)
+{
+    m_folders.clear();
+    m_files.clear();
+    m_folderIds.clear();
+    m_fileIds.clear();
+
+    // Files selected one by one, by folder ID
+    QMap<int, QSet<int>> singleFiles;
+
+    for (TreeItem *item : items) {
+        addAncestors(item);
+
+        if (!item->isFoler())
+            singleFiles[item->parentItem()->id()].insert(item->id());
+        else if (item->id() == 0)
+            addSubtree(0);  // Database item
+        else if (!m_folderIds.contains(item->id())) {
+            addFolder(item->id(), item->parentItem()->id(), item->name());
+            addSubtree(item->id());
+        }
+    }
+
+    // Rows are taken from the database, not from the tree:
+    // the tree may have files of huge folders not loaded yet
+    for (auto it = singleFiles.cbegin(); it != singleFiles.cend(); ++it) {
+        const QVector<FileRecord> files = m_backend->files(it.key());
+        for (const FileRecord &file : files)
+            if (it.value().contains(file.id) && !m_fileIds.contains(file.id)) {
+                m_fileIds.insert(file.id);
+                m_files.append(file);
+            }
+    }
+
+    if (m_files.isEmpty() && m_folders.isEmpty()) {
+        m_lastErrorMsg = "Nothing to repack.";
+        return false;
+    }
+
+    return true;
+}
+
+void Repacker::addAncestors(TreeItem *item)
+{
+    // Root folder ID is 0, it is the database item
+    QVector<TreeItem*> ancestors;
+    for (TreeItem *parent = item->parentItem(); parent && (parent->id() != 0); parent = parent->parentItem())
+        ancestors.prepend(parent);
+
+    for (TreeItem *folder : qAsConst(ancestors))
+        addFolder(folder->id(), folder->parentItem()->id(), folder->name());
+}
+
+void Repacker::addFolder(int id, int parentId, const QString &name)
+{
+    if (m_folderIds.contains(id))
+        return;
+
+    m_folderIds.insert(id);
+    m_folders.append({ id, parentId, name });
+}
+
+void Repacker::addSubtree(int folderId)
+{
+    const QVector<FolderRecord> folders = m_backend->folders(folderId);
+    for (const FolderRecord &folder : folders) {
+        addFolder(folder.id, folder.parentId, folder.name);
+        addSubtree(folder.id);
+    }
+
+    const QVector<FileRecord> files = m_backend->files(folderId);
+    for (const FileRecord &file : files)
+        if (!m_fileIds.contains(file.id)) {
+            m_fileIds.insert(file.id);
+            m_files.append(file);
+        }
+}
+
+bool Repacker::createDatabase(const QString &path)
+{
+    QString isql = qEnvironmentVariable("ISQL");
+    if (isql.isEmpty())
+        isql = QStandardPaths::findExecutable("isql-fb");
+    if (isql.isEmpty())
+        isql = QStandardPaths::findExecutable("isql");
+    if (isql.isEmpty()) {
+        m_lastErrorMsg = "Firebird isql tool not found, set ISQL environment variable or use *.sqlite output.";
+        return false;
+    }
+
+    QTemporaryFile script;
+    if (!script.open()) {
+        m_lastErrorMsg = "Can't create isql script file.";
+        return false;
+    }
+
+    QTextStream ts(&script);
+    ts << QString("CREATE DATABASE %1 USER %2 PASSWORD %3 PAGE_SIZE 4096;\n")
+              .arg(quoted(QDir::toNativeSeparators(QFileInfo(path).absoluteFilePath())),
+                   quoted(m_user),
+                   quoted(m_password));
+    for (const char *statement : firebirdSchema)
+        ts << statement << "\n";
+    ts << "COMMIT;\n";
+    ts.flush();
+    script.close();
+
+    QProcess process;
+    process.start(isql, QStringList() << "-q" << "-i" << script.fileName());
+    if (!process.waitForFinished(-1) || (process.exitCode() != 0)) {
+        m_lastErrorMsg = QString("isql failed: %1").arg(QString::fromLocal8Bit(process.readAllStandardError()));
+        return false;
+    }
+
+    return true;
+}
+
+bool Repacker::write(QSqlDatabase &db, bool sqlite)
+{
+    QSqlQuery query(db);
+
+    if (sqlite) {
+        const QStringList schema = SqliteConverter::schema();
+        for (const QString &statement : schema)
+            if (!query.exec(statement)) {
+                m_lastErrorMsg = query.lastError().databaseText();
+                return false;
+            }
+    }
+
+    // Folders
+    db.transaction();
+    QSqlQuery folderQuery(db);
+    folderQuery.prepare("INSERT INTO FOLDERS (ID, PARENTID, FOLDERNAME) VALUES (?, ?, ?)");
+    for (const FolderRecord &folder : qAsConst(m_folders)) {
+        folderQuery.addBindValue(folder.id);
+        folderQuery.addBindValue(folder.parentId);
+        folderQuery.addBindValue(folder.name);
+        if (!folderQuery.exec()) {
+            m_lastErrorMsg = folderQuery.lastError().databaseText();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        m_lastErrorMsg = db.lastError().databaseText();
+        return false;
+    }
+
+    // Files in storage order of the source, BLOBs are read sequentially then
+    QVector<int> ids;
+    QHash<int, int> indexOf;
+    for (int i = 0; i < m_files.count(); i++) {
+        ids.append(m_files.at(i).id);
+        indexOf.insert(m_files.at(i).id, i);
+    }
+    m_backend->sortByStorage(&ids);
+
+    QSqlQuery dataQuery(db);
+    dataQuery.prepare("INSERT INTO DATA (ID, FOLDERID, MODULENAME, KIND, DATASIZE, CREATEDDATE, DATA, PROFILE) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+
+    auto fetch = [&](int index, RepackJob &job) {
+        job.file = m_files.at(indexOf.value(ids.at(index)));
+        job.data = m_backend->blob(job.file.id, "DATA");
+        job.profile = m_backend->blob(job.file.id, "PROFILE");
+        job.level = m_level;
+        job.repacked = false;
+        m_inputBytes += job.data.size();
+        return (qint64)job.data.size() + job.profile.size();
+    };
+
+    // Every batch is written in its own transaction
+    auto done = [&](const QVector<RepackJob> &batch, int) {
+        db.transaction();
+        for (const RepackJob &job : batch) {
+            dataQuery.addBindValue(job.file.id);
+            dataQuery.addBindValue(job.file.folderId);
+            dataQuery.addBindValue(job.file.name);
+            dataQuery.addBindValue(job.file.kind);
+            dataQuery.addBindValue(job.file.size);
+            if (sqlite)
+                dataQuery.addBindValue(job.file.ctime.toString(Qt::ISODateWithMs));
+            else
+                dataQuery.addBindValue(job.file.ctime);
+            dataQuery.addBindValue(job.data);
+            dataQuery.addBindValue(job.profile);
+            if (!dataQuery.exec()) {
+                m_lastErrorMsg = dataQuery.lastError().databaseText();
+                db.rollback();
+                return false;
+            }
+
+            m_outputBytes += job.data.size();
+            if (job.repacked)
+                m_repackedCount++;
+        }
+        if (!db.commit()) {
+            m_lastErrorMsg = db.lastError().databaseText();
+            return false;
+        }
+
+        m_writtenCount += batch.count();
+        emit progress(m_writtenCount, ids.count());
+
+        if (m_canceled) {
+            m_lastErrorMsg = "Canceled by user.";
+            return false;
+        }
+
+        return true;
+    };
+
+    if (!BatchPipeline::run(ids.count(), fetch, repackJob, done))
+        return false;
+
+    // Indices are built after all records are inserted, it's much faster
+    const QStringList indices = SqliteConverter::indices();
+    for (const QString &statement : indices)
+        if (!query.exec(statement)) {
+            m_lastErrorMsg = query.lastError().databaseText();
+            return false;
+        }
+
+    return true;
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef REPACKER_H
+#define REPACKER_H
+
+#include <QObject>
+#include <QtSql>
+#include "SqlCore/SqlCore.h"
+#include "TreeItem/TreeItem.h"
+
+// Writes selected folders and files of an opened database into a new
+// database with the same FOLDERS/DATA schema: Firebird (*.pcr, *.fdb, the
+// file is created by "isql" tool) or SQLite (*.sqlite). DATA BLOBs are
+// inflated and deflated again at the given level on the thread pool, a BLOB
+// is copied as is if it can't be inflated or doesn't get smaller.
+class Repacker : public QObject
+{
+    Q_OBJECT
+public:
+    static const int DEFAULT_LEVEL = 9;
+
+    explicit Repacker(SqlCore *sqlCore, QObject *parent = nullptr);
+
+    // zlib compression level, 0..9
+    void setLevel(int level) { m_level = level; }
+    int level() const { return m_level; }
+    // Firebird credentials of the new database, see FirebirdBackend
+    void setCredentials(const QString &user, const QString &password);
+
+    // Folders are written with their subfolders and files, ancestors of the
+    // items are written too, so paths stay the same. The database item
+    // means the whole database.
+    bool repack(const QString &path, const QList<TreeItem*> &items);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+    // Statistics of the last repack() call
+    int writtenCount() const { return m_writtenCount; }
+    int repackedCount() const { return m_repackedCount; }   // DATA BLOBs deflated again
+    qint64 inputBytes() const { return m_inputBytes; }      // DATA BLOBs before and after
+    qint64 outputBytes() const { return m_outputBytes; }
+
+    // 32-bit length prefix followed by zlib stream, as SqlCore::rawData
+    // expects. Returns empty array on error.
+    static QByteArray packBlob(const QByteArray &data, int level);
+
+signals:
+    void progress(int done, int total);
+
+public slots:
+    void cancel() { m_canceled = true; }
+
+private:
+    SqlCore *m_sqlCore;
+    StorageBackend *m_backend;
+    int m_level;
+    QString m_user, m_password;
+    bool m_canceled;
+    QString m_lastErrorMsg;
+
+    int m_writtenCount, m_repackedCount;
+    qint64 m_inputBytes, m_outputBytes;
+
+    // Records to write, folders go before their subfolders
+    QVector<FolderRecord> m_folders;
+    QVector<FileRecord> m_files;
+    QSet<int> m_folderIds, m_fileIds;
+
+    bool select(const QList<TreeItem*> &items);
+    void addAncestors(TreeItem *item);
+    void addFolder(int id, int parentId, const QString &name);
+    void addSubtree(int folderId);
+    bool createDatabase(const QString &path);
+    bool write(QSqlDatabase &db, bool sqlite);
+};
+
+#endif // REPACKER_H
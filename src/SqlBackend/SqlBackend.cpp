@@ -0,0 +1,275 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "SqlBackend.h"
+#include "Tracer/Tracer.h"
+
+// Firebird limits IN predicate to 1500 values
+static const int MAX_IN_VALUES = 1000;
+
+// Wildcard pattern (* and ?) as upper case LIKE pattern, "\" is escape character
+static QString likePattern(const QString &wildcard)
+{
+    QString result;
+
+    for (const QChar c : wildcard) {
+        if (c == '*')
+            result += '%';
+        else if (c == '?')
+            result += '_';
+        else {
+            if ((c == '%') || (c == '_') || (c == '\\'))
+                result += '\\';
+            result += c;
+        }
+    }
+
+    return result.toUpper();
+}
+
+SqlBackend::SqlBackend(const QString &driver) :
+    m_connectionName(QString("%1-%2").arg(driver).arg((quintptr)this, 0, 16))
+{
+    m_db = QSqlDatabase::addDatabase(driver, m_connectionName);
+}
+
+SqlBackend::~SqlBackend()
+{
+    close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool SqlBackend::open(const QString &path)
+{
+    close();
+    m_lastErrorMsg.clear();
+
+    m_db.setDatabaseName(path);
+    return m_db.open();
+}
+
+void SqlBackend::close()
+{
+    if (m_db.isOpen())
+        m_db.close();
+}
+
+QString SqlBackend::lastErrorMsg() const
+{
+    if (!m_lastErrorMsg.isEmpty())
+        return m_lastErrorMsg;
+    else
+        return m_db.lastError().databaseText();
+}
+
+QVector<FolderRecord> SqlBackend::folders(int parentId)
+{
+    TRACE_SCOPE("query folders");
+    Tracer::count("queries");
+
+    QVector<FolderRecord> result;
+    QSqlQuery query(m_db);
+    QString queryText;
+
+    queryText = QString("SELECT ID,FOLDERNAME "
+                        "FROM FOLDERS "
+                        "WHERE PARENTID=%1;")
+                    .arg(parentId);
+    if (!query.exec(queryText)) {
+        qDebug() << query.lastError();
+        return result;
+    }
+
+    while (query.next()) {
+        FolderRecord record;
+        record.id = query.value(0).toInt();
+        record.parentId = parentId;
+        record.name = query.value(1).toString();
+        result.append(record);
+    }
+
+    return result;
+}
+
+QVector<FileRecord> SqlBackend::files(int folderId)
+{
+    TRACE_SCOPE("query files");
+    Tracer::count("queries");
+
+    QVector<FileRecord> result;
+    QSqlQuery query(m_db);
+    QString queryText;
+
+    queryText = QString("SELECT ID,MODULENAME,KIND,DATASIZE,CREATEDDATE "
+                        "FROM DATA "
+                        "WHERE FOLDERID=%1;")
+                    .arg(folderId);
+    if (!query.exec(queryText)) {
+        qDebug() << query.lastError();
+        return result;
+    }
+
+    while (query.next()) {
+        FileRecord record;
+        record.id = query.value(0).toInt();
+        record.folderId = folderId;
+        record.name = query.value(1).toString();
+        record.kind = query.value(2).toInt();
+        record.size = query.value(3).toInt();
+        record.ctime = query.value(4).toDateTime();
+        result.append(record);
+    }
+
+    return result;
+}
+
+bool SqlBackend::files(int folderId, int afterId, int limit, QVector<FileRecord> *files)
+{
+    TRACE_SCOPE("query files page");
+    Tracer::count("queries");
+
+    files->clear();
+    QSqlQuery query(m_db);
+    QString queryText;
+
+    // Keyset pagination: every page starts after the last ID of the previous one
+    queryText = QString("SELECT ID,MODULENAME,KIND,DATASIZE,CREATEDDATE "
+                        "FROM DATA "
+                        "WHERE FOLDERID=%1 AND ID>%2 "
+                        "ORDER BY ID %3;")
+                    .arg(folderId)
+                    .arg(afterId)
+                    .arg(limitClause(limit));
+    query.setForwardOnly(true);
+    if (!query.exec(queryText)) {
+        qDebug() << query.lastError();
+        m_lastErrorMsg = query.lastError().databaseText();
+        return false;
+    }
+
+    while (query.next()) {
+        FileRecord record;
+        record.id = query.value(0).toInt();
+        record.folderId = folderId;
+        record.name = query.value(1).toString();
+        record.kind = query.value(2).toInt();
+        record.size = query.value(3).toInt();
+        record.ctime = query.value(4).toDateTime();
+        files->append(record);
+    }
+
+    return true;
+}
+
+bool SqlBackend::findFiles(const FileFilter &filter, QVector<FileRecord> *files)
+{
+    TRACE_SCOPE("query find files");
+
+    QStringList conditions;
+    QVariantList values;
+
+    if (!filter.kinds.isEmpty()) {
+        QStringList kinds;
+        for (int kind : filter.kinds)
+            kinds.append(QString::number(kind));
+        conditions.append(QString("KIND IN (%1)").arg(kinds.join(',')));
+    }
+
+    if (filter.from.isValid()) {
+        conditions.append("CREATEDDATE>=?");
+        values.append(filter.from);
+    }
+
+    if (filter.to.isValid()) {
+        conditions.append("CREATEDDATE<=?");
+        values.append(filter.to);
+    }
+
+    if (filter.minSize >= 0)
+        conditions.append(QString("DATASIZE>=%1").arg(filter.minSize));
+
+    if (filter.maxSize >= 0)
+        conditions.append(QString("DATASIZE<=%1").arg(filter.maxSize));
+
+    if (!filter.name.isEmpty()) {
+        conditions.append("UPPER(MODULENAME) LIKE ? ESCAPE '\\'");
+        values.append(likePattern(filter.name));
+    }
+
+    files->clear();
+
+    // Long folder list is split into several queries
+    for (int i = 0; (i == 0) || (i < filter.folderIds.count()); i += MAX_IN_VALUES) {
+        QStringList where = conditions;
+
+        if (!filter.folderIds.isEmpty()) {
+            QStringList ids;
+            for (int id : filter.folderIds.mid(i, MAX_IN_VALUES))
+                ids.append(QString::number(id));
+            where.append(QString("FOLDERID IN (%1)").arg(ids.join(',')));
+        }
+
+        QString queryText = "SELECT ID,FOLDERID,MODULENAME,KIND,DATASIZE,CREATEDDATE "
+                            "FROM DATA";
+        if (!where.isEmpty())
+            queryText += " WHERE " + where.join(" AND ");
+
+        QSqlQuery query(m_db);
+        query.setForwardOnly(true);
+        query.prepare(queryText);
+        for (const QVariant &value : qAsConst(values))
+            query.addBindValue(value);
+
+        Tracer::count("queries");
+        if (!query.exec()) {
+            qDebug() << query.lastError();
+            m_lastErrorMsg = query.lastError().databaseText();
+            return false;
+        }
+
+        while (query.next()) {
+            FileRecord record;
+            record.id = query.value(0).toInt();
+            record.folderId = query.value(1).toInt();
+            record.name = query.value(2).toString();
+            record.kind = query.value(3).toInt();
+            record.size = query.value(4).toInt();
+            record.ctime = query.value(5).toDateTime();
+            files->append(record);
+        }
+    }
+
+    return true;
+}
+
+QByteArray SqlBackend::blob(int id, const QString &blobName)
+{
+    TRACE_SCOPE("fetch blob");
+    Tracer::count("queries");
+
+    QSqlQuery query(m_db);
+    QString queryText;
+
+    queryText = QString("SELECT %1 "
+                        "FROM DATA "
+                        "WHERE ID=%2;")
+                    .arg(blobName)
+                    .arg(id);
+    if (!query.exec(queryText)) {
+        qDebug() << query.lastError();
+        return QByteArray();
+    }
+
+    if (!query.first())
+        return QByteArray();
+
+    const QByteArray data = query.value(0).toByteArray();
+    Tracer::count("bytes fetched", data.size());
+    return data;
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef SQLBACKEND_H
+#define SQLBACKEND_H
+
+#include <QtSql>
+#include "StorageBackend/StorageBackend.h"
+
+// Common part of backends working over Qt SQL drivers,
+// each instance uses its own named connection
+class SqlBackend : public StorageBackend
+{
+public:
+    explicit SqlBackend(const QString &driver);
+    ~SqlBackend();
+
+    bool open(const QString &path) override;
+    void close() override;
+    QString lastErrorMsg() const override;
+
+    QVector<FolderRecord> folders(int parentId) override;
+    QVector<FileRecord> files(int folderId) override;
+    bool files(int folderId, int afterId, int limit, QVector<FileRecord> *files) override;
+    bool findFiles(const FileFilter &filter, QVector<FileRecord> *files) override;
+    QByteArray blob(int id, const QString &blobName) override;
+
+protected:
+    QSqlDatabase m_db;
+    QString m_lastErrorMsg;
+
+    // Row limit clause at the end of SELECT statement
+    virtual QString limitClause(int limit) const { return QString("LIMIT %1").arg(limit); }
+
+private:
+    QString m_connectionName;
+};
+
+#endif // SQLBACKEND_H
@@ -7,64 +7,201 @@
 ****************************************************************************/
 
 #include "SqlCore.h"
-#include <QtZlib/zlib.h>
+#include "FirebirdBackend/FirebirdBackend.h"
+#include "SqliteBackend/SqliteBackend.h"
+#include "OdsBackend/OdsBackend.h"
+#include "CatalogCache/CatalogCache.h"
+#include "Tracer/Tracer.h"
+#include "RecordCache/RecordCache.h"
 
 SqlCore::SqlCore(QObject *parent)
     : QObject{parent},
     m_fileCounter(0),
     m_folderCounter(0),
-    m_totalSize(0)
+    m_totalSize(0),
+    m_backend(nullptr),
+    m_engine(AutoEngine),
+    m_inflateContext(new InflateContext),
+    m_indexCache(64 * 1024),
+    m_cacheId(RecordCache::newDatabaseId()),
+    m_pageSize(0)
 {
-    m_db = QSqlDatabase::addDatabase("QIBASE");
+
+}
+
+SqlCore::~SqlCore()
+{
+    RecordCache::remove(m_cacheId);
+    delete m_backend;
+    delete m_inflateContext;
+}
+
+QString SqlCore::lastErrorMsg() const
+{
+    if (!m_pendingErrorMsg.isEmpty())
+        return m_pendingErrorMsg;
+    else if (m_backend)
+        return m_backend->lastErrorMsg();
+    else
+        return QString();
+}
+
+void SqlCore::setCredentials(const QString &user, const QString &password)
+{
+    m_user = user;
+    m_password = password;
 }
 
 bool SqlCore::open(const QString &path)
 {
+    TRACE_SCOPE("open");
+
     m_fileCounter = 0;
     m_folderCounter = 0;
     m_totalSize = 0;
+    m_pendingPath.clear();
+    m_pendingErrorMsg.clear();
+    m_indexCache.clear();
+    RecordCache::remove(m_cacheId);
+
+    delete m_backend;
 
-    if (m_db.isOpen())
-        m_db.close();
+    // Backend is chosen by file signature, not by file extension
+    if (SqliteBackend::isSqliteFile(path)) {
+        m_backend = new SqliteBackend;
+        return m_backend->open(path);
+    }
+
+    QString nativeErrorMsg;
+    if ((m_engine == NativeEngine)
+        || ((m_engine == AutoEngine) && OdsReader::isOdsFile(path))) {
+        m_backend = new OdsBackend;
+        if (m_backend->open(path))
+            return true;
+        if (m_engine == NativeEngine)
+            return false;
+
+        // Auto engine falls back to Firebird, reason is kept for the case it fails too
+        Tracer::count("native reader fallbacks");
+        nativeErrorMsg = m_backend->lastErrorMsg();
+        delete m_backend;
+    }
+
+    FirebirdBackend *backend = new FirebirdBackend;
+    if (!m_user.isEmpty())
+        backend->setCredentials(m_user, m_password);
+    m_backend = backend;
 
-    m_db.setDatabaseName(path);
-    m_db.setUserName("SYSDBA");
-    m_db.setPassword("masterkey");
+    if (m_backend->open(path))
+        return true;
 
-    return m_db.open();
+    if (!nativeErrorMsg.isEmpty())
+        m_pendingErrorMsg = m_backend->lastErrorMsg() + "\nNative reader: " + nativeErrorMsg;
+
+    return false;
 }
 
-void SqlCore::enumerate(TreeItem *parentItem)
+SqlCore::Engine SqlCore::engineFromString(const QString &name)
 {
-    if (!parentItem)
-        return;
+    if (name.compare("firebird", Qt::CaseInsensitive) == 0)
+        return FirebirdEngine;
+    if (name.compare("native", Qt::CaseInsensitive) == 0)
+        return NativeEngine;
+    return AutoEngine;
+}
 
-    QSqlQuery query;
-    QString queryText;
+void SqlCore::copySettings(const SqlCore *other)
+{
+    m_user = other->m_user;
+    m_password = other->m_password;
+    m_engine = other->m_engine;
+    m_pageSize = other->m_pageSize;
+    setInflateEngine(other->inflateEngine());
+}
 
-    // Folder enumeration
-    queryText = QString("SELECT ID,FOLDERNAME "
-                        "FROM FOLDERS "
-                        "WHERE PARENTID=%1;")
-                    .arg(parentItem->id());
-    if (!query.exec(queryText)) {
-        qDebug() << query.lastError();
-        return;
+bool SqlCore::setInflateEngine(const QString &name)
+{
+    // Thread pool jobs (verification, comparison, repacking) use the same engine
+    return m_inflateContext->setEngine(name) && InflateContext::setLocalEngine(name);
+}
+
+void SqlCore::openLater(const QString &path)
+{
+    m_fileCounter = 0;
+    m_folderCounter = 0;
+    m_totalSize = 0;
+    m_pendingErrorMsg.clear();
+    m_indexCache.clear();
+    RecordCache::remove(m_cacheId);
+
+    delete m_backend;
+    m_backend = nullptr;
+
+    m_pendingPath = path;
+}
+
+bool SqlCore::load(const QString &path, TreeItem *parentItem)
+{
+    TRACE_SCOPE("load catalog");
+
+    if (CatalogCache::load(path, parentItem)) {
+        openLater(path);
+        count(parentItem);
+        // Cache could be saved with folders loaded partially
+        return m_pageSize || fetchAll(parentItem);
+    }
+
+    if (!open(path))
+        return false;
+
+    enumerate(parentItem);
+    CatalogCache::save(path, parentItem);
+
+    return true;
+}
+
+bool SqlCore::openPending()
+{
+    // Nothing postponed, or postponed opening has already failed
+    if (m_pendingPath.isEmpty())
+        return (m_backend != nullptr) && m_pendingErrorMsg.isEmpty();
+
+    // Statistics must survive postponed opening
+    const int fileCounter = m_fileCounter;
+    const int folderCounter = m_folderCounter;
+    const qint64 totalSize = m_totalSize;
+
+    const QString path = m_pendingPath;
+    const bool ok = open(path);
+    if (!ok) {
+        m_pendingErrorMsg = lastErrorMsg();
+        if (m_pendingErrorMsg.isEmpty())
+            m_pendingErrorMsg = "Database opening error!";
     }
 
-    while (query.next())
-    {
-        int id = query.value("ID").toInt();
-        QString name = query.value("FOLDERNAME").toString();
+    m_fileCounter = fileCounter;
+    m_folderCounter = folderCounter;
+    m_totalSize = totalSize;
+
+    return ok;
+}
+
+void SqlCore::enumerate(TreeItem *parentItem)
+{
+    if (!parentItem || !openPending())
+        return;
+
+    // Folder enumeration
+    const QVector<FolderRecord> folders = m_backend->folders(parentItem->id());
+    for (const FolderRecord &folder : folders) {
+        QString name = folder.name;
 
         // If name is empty we will use ID as name
         if (name.isEmpty())
-            name = QString("%1").arg(id, 8, 16, QChar('0'));
-
-        // qDebug() << id << name;
+            name = QString("%1").arg(folder.id, 8, 16, QChar('0'));
 
         // New folder item
-        TreeItem *childItem = new TreeItem(id, name, parentItem);
+        TreeItem *childItem = new TreeItem(folder.id, name, parentItem);
         parentItem->append(childItem);
 
         m_folderCounter++;
@@ -73,89 +210,164 @@ void SqlCore::enumerate(TreeItem *parentItem)
         enumerate(childItem);
     }
 
-    // File enumeration
-    queryText = QString("SELECT ID,MODULENAME,KIND,DATASIZE,CREATEDDATE "
-                        "FROM DATA "
-                        "WHERE FOLDERID=%1;")
-                    .arg(parentItem->id());
-    if (!query.exec(queryText)) {
-        qDebug() << query.lastError();
-        return;
-    }
+    // File enumeration, huge folders are loaded by pages. A folder whose
+    // first page fails stays partial, fetchFiles() tries it again.
+    QVector<FileRecord> files;
+    bool more = false;
+    if (m_pageSize)
+        more = !m_backend->files(parentItem->id(), std::numeric_limits<int>::min(), m_pageSize, &files)
+               || (files.count() == m_pageSize);
+    else
+        files = m_backend->files(parentItem->id());
 
-    while (query.next()) {
-        int id = query.value("ID").toInt();
-        int size = query.value("DATASIZE").toInt();
-        int type = query.value("KIND").toInt();
-        QString name = query.value("MODULENAME").toString();
-        QDateTime ctime = query.value("CREATEDDATE").toDateTime();
+    for (const FileRecord &file : files)
+        parentItem->append(newFileItem(file, parentItem));
 
-        if (name.isEmpty())
-            name = QString("%1").arg(id, 8, 16, QChar('0'));
+    if (more)
+        parentItem->setMoreFiles(true);
+}
 
-        // qDebug() << id << name << size;
+TreeItem *SqlCore::newFileItem(const FileRecord &file, TreeItem *parentItem)
+{
+    QString name = file.name;
 
-        // New file item
-        TreeItem *childItem = new TreeItem(id, size, (TreeItem::DataType)type, name, ctime, parentItem);
-        parentItem->append(childItem);
+    if (name.isEmpty())
+        name = QString("%1").arg(file.id, 8, 16, QChar('0'));
 
-        m_fileCounter++;
-        m_totalSize += size;
-    }
+    m_fileCounter++;
+    m_totalSize += file.size;
+
+    return new TreeItem(file.id, file.size, (TreeItem::DataType)file.kind, name, file.ctime, parentItem);
 }
 
-QByteArray SqlCore::rawData(TreeItem *item)
+bool SqlCore::fetchFiles(TreeItem *folder, QVector<TreeItem*> *items)
 {
-    // Compressed raw data
-    QByteArray in = blobData(item->id(), "DATA");
+    items->clear();
 
-    if (in.size() < (int)sizeof(unsigned long)) {
-        qDebug() << "BLOB size too small!";
-        return QByteArray();
+    if (!folder->hasMoreFiles())
+        return true;
+
+    if (!openPending())
+        return false;
+
+    TRACE_SCOPE("fetch files");
+
+    // Files follow subfolders in ID order, the next page starts after the last one
+    TreeItem *last = folder->childItem(folder->childCount() - 1);
+    const int afterId = (last && !last->isFoler()) ? last->id() : std::numeric_limits<int>::min();
+    const int limit = m_pageSize ? m_pageSize : std::numeric_limits<int>::max();
+
+    QVector<FileRecord> files;
+    if (!m_backend->files(folder->id(), afterId, limit, &files))
+        return false;
+
+    for (const FileRecord &file : files)
+        items->append(newFileItem(file, nullptr));
+
+    // A short page is the last one
+    if (files.count() < limit)
+        folder->setMoreFiles(false);
+
+    return true;
+}
+
+bool SqlCore::fetchAll(TreeItem *parentItem)
+{
+    const TreeItem::Aggregate *aggregate = parentItem->aggregate();
+
+    if (!aggregate || !aggregate->partialCount)
+        return true;
+
+    QVector<TreeItem*> items;
+    while (parentItem->hasMoreFiles()) {
+        if (!fetchFiles(parentItem, &items))
+            return false;
+        for (TreeItem *item : qAsConst(items))
+            parentItem->append(item);
     }
 
-    // Uncompressed data length
-    unsigned long *length = (unsigned long *)in.data();
+    for (int i = 0; i < parentItem->childCount(); i++)
+        if (!fetchAll(parentItem->childItem(i)))
+            return false;
+
+    return true;
+}
+
+void SqlCore::count(TreeItem *parentItem)
+{
+    // Folder statistics are collected while the tree is built
+    const TreeItem::Aggregate *aggregate = parentItem->aggregate();
 
-    // Uncompressed raw data
-    QByteArray out(*length, 0);
+    if (!aggregate)
+        return;
 
-    // Zlib magic happens here
-    int err = uncompress((uchar *)out.data(), // Destination (uncompressed) buffer
-                         length,
-                         (uchar *)in.data() + sizeof(unsigned long), // Source (compressed) buffer
-                         in.size() - sizeof(unsigned long));
+    m_fileCounter += aggregate->fileCount;
+    m_folderCounter += aggregate->folderCount;
+    m_totalSize += aggregate->totalSize;
+}
+
+QByteArray SqlCore::rawData(TreeItem *item)
+{
+    QByteArray out;
+    rawData(item, &out);
+    return out;
+}
+
+bool SqlCore::rawData(TreeItem *item, QByteArray *out)
+{
+    if (!openPending()) {
+        out->resize(0);
+        return false;
+    }
 
-    if (err != Z_OK) {
+    // Compressed raw data: 32-bit little-endian uncompressed length prefix
+    // (it was written by 32-bit Windows code, so "unsigned long" is 4 bytes here)
+    // followed by zlib stream
+    if (!m_inflateContext->inflateBlob(m_backend->blob(item->id(), "DATA"), out)) {
         qDebug() << "BLOB uncompress error!";
-        return QByteArray();
+        return false;
     }
 
-    return out;
+    return true;
 }
 
-QByteArray SqlCore::rawProfile(TreeItem *item)
+RecordDevice *SqlCore::dataDevice(TreeItem *item, QObject *parent)
 {
-    return blobData(item->id(), "PROFILE");
+    if (!openPending())
+        return nullptr;
+
+    return dataDevice(item, m_backend->blob(item->id(), "DATA"), parent);
 }
 
-QByteArray SqlCore::blobData(int id, const QString &blobName)
+RecordDevice *SqlCore::dataDevice(TreeItem *item, const QByteArray &blob, QObject *parent)
 {
-    QSqlQuery query;
-    QString queryText;
+    QSharedPointer<InflateIndex> index;
+
+    if (item->size() >= InflateIndex::MIN_RECORD_SIZE) {
+        if (m_indexCache.contains(item->id()))
+            index = *m_indexCache.object(item->id());
+        else {
+            index.reset(new InflateIndex);
+            m_indexCache.insert(item->id(),
+                                new QSharedPointer<InflateIndex>(index),
+                                InflateIndex::cost(item->size()));
+        }
+    }
 
-    queryText = QString("SELECT %1 "
-                        "FROM DATA "
-                        "WHERE ID=%2;")
-                    .arg(blobName)
-                    .arg(id);
-    if (!query.exec(queryText)) {
-        qDebug() << query.lastError();
-        return QByteArray();
+    RecordDevice *device = new RecordDevice(blob, index, m_cacheId, item->id(), parent);
+
+    if (!device->isValid()) {
+        delete device;
+        return nullptr;
     }
 
-    if (query.first())
-        return query.value(blobName).toByteArray();
-    else
+    return device;
+}
+
+QByteArray SqlCore::rawProfile(TreeItem *item)
+{
+    if (!openPending())
         return QByteArray();
+
+    return m_backend->blob(item->id(), "PROFILE");
 }
@@ -10,19 +10,69 @@
 #define SQLCORE_H
 
 #include <QObject>
-#include <QtSql>
+#include <QCache>
+#include "StorageBackend/StorageBackend.h"
 #include "TreeItem/TreeItem.h"
+#include "RecordDevice/RecordDevice.h"
+#include "InflateContext/InflateContext.h"
 
 class SqlCore : public QObject
 {
     Q_OBJECT
 public:
+    // Database engine for PC-3000 files: native reader is tried first in
+    // auto mode, Firebird client is used if the reader can't handle the file
+    enum Engine { AutoEngine, FirebirdEngine, NativeEngine };
+
     explicit SqlCore(QObject *parent = nullptr);
-    QString lastErrorMsg() const { return m_db.lastError().databaseText(); }
+    ~SqlCore();
+    QString lastErrorMsg() const;
     bool open(const QString &path);
+    // Postpones connection until the first data request or openPending() call
+    void openLater(const QString &path);
+    // Opens database and fills the tree from catalog cache (connection is
+    // postponed then) or by enumeration
+    bool load(const QString &path, TreeItem *parentItem);
+    bool openPending();
     void enumerate(TreeItem *parentItem);
+    // Updates statistics for the tree loaded without enumeration
+    void count(TreeItem *parentItem);
+    // Files of a folder are enumerated by pages of this size, the rest is
+    // loaded by fetchFiles(). 0 (default) loads all files at once.
+    void setPageSize(int files) { m_pageSize = files; }
+    int pageSize() const { return m_pageSize; }
+    // Next page of files of the folder loaded partially. Items are not
+    // appended to the folder, so a model can announce them first.
+    // Returns false on error, the folder stays partial then.
+    bool fetchFiles(TreeItem *folder, QVector<TreeItem*> *items);
+    // Appends all files not loaded yet to the subtree, returns false on error
+    bool fetchAll(TreeItem *parentItem);
     QByteArray rawData(TreeItem *item);
+    // The same, but output buffer is reused: no allocations if it is large enough
+    bool rawData(TreeItem *item, QByteArray *out);
     QByteArray rawProfile(TreeItem *item);
+    // Random access to uncompressed data without inflating it all at once,
+    // returns nullptr on error. Inflate checkpoints of large records are kept
+    // until the database is closed, so the next view seeks quickly. Inflated
+    // pages go to RecordCache shared with other open databases.
+    RecordDevice *dataDevice(TreeItem *item, QObject *parent = nullptr);
+    // The same for DATA BLOB of the item loaded elsewhere (see RecordLoader)
+    RecordDevice *dataDevice(TreeItem *item, const QByteArray &blob, QObject *parent = nullptr);
+
+    // Firebird credentials, used by next open() calls
+    void setCredentials(const QString &user, const QString &password);
+    void setEngine(Engine engine) { m_engine = engine; }
+    static Engine engineFromString(const QString &name);
+    // Decompression engine of rawData(), see Inflater::engines().
+    // Returns false for unknown engine.
+    bool setInflateEngine(const QString &name);
+    QString inflateEngine() const { return m_inflateContext->engine(); }
+
+    // Copies credentials, database and decompression engines of another core
+    void copySettings(const SqlCore *other);
+
+    // Storage backend of the opened database
+    StorageBackend *backend() { openPending(); return m_backend; }
 
     // Statistics
     int fileCount() { return m_fileCounter; }
@@ -32,8 +82,17 @@ public:
 private:
     int m_fileCounter, m_folderCounter;
     qint64 m_totalSize;
-    QSqlDatabase m_db;
-    QByteArray blobData(int id, const QString &blobName);
+    StorageBackend *m_backend;
+    QString m_user, m_password;
+    Engine m_engine;
+    InflateContext *m_inflateContext;
+    QString m_pendingPath;
+    QString m_pendingErrorMsg;
+    QCache<int, QSharedPointer<InflateIndex>> m_indexCache;  // Cost is in KiB
+    int m_cacheId;  // Database ID in RecordCache
+    int m_pageSize;
+
+    TreeItem *newFileItem(const FileRecord &file, TreeItem *parentItem);
 };
 
 #endif // SQLCORE_H
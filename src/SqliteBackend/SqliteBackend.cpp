@@ -0,0 +1,42 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "SqliteBackend.h"
+
+SqliteBackend::SqliteBackend() :
+    SqlBackend("QSQLITE")
+{
+
+}
+
+bool SqliteBackend::open(const QString &path)
+{
+    // Mirror is never modified by the viewer
+    m_db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+    if (!SqlBackend::open(path))
+        return false;
+
+    const QStringList tables = m_db.tables();
+    if (!tables.contains("FOLDERS") || !tables.contains("DATA")) {
+        m_lastErrorMsg = "Not a PC-3000 database mirror: FOLDERS or DATA table is missing.";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool SqliteBackend::isSqliteFile(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    return f.read(16) == QByteArray("SQLite format 3\0", 16);
+}
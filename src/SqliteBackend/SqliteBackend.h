@@ -0,0 +1,27 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef SQLITEBACKEND_H
+#define SQLITEBACKEND_H
+
+#include "SqlBackend/SqlBackend.h"
+
+// SQLite mirror of the PC-3000 database made by SqliteConverter
+class SqliteBackend : public SqlBackend
+{
+public:
+    SqliteBackend();
+
+    QString name() const override { return "SQLite"; }
+    bool open(const QString &path) override;
+
+    // Checks SQLite file signature
+    static bool isSqliteFile(const QString &path);
+};
+
+#endif // SQLITEBACKEND_H
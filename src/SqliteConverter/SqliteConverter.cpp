@@ -0,0 +1,182 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "SqliteConverter.h"
+
+static const char *connectionName = "SqliteConverter";
+
+static const char *schemaStatements[] = {
+    "PRAGMA journal_mode=OFF;",
+    "PRAGMA synchronous=OFF;",
+    "PRAGMA page_size=4096;",
+
+    "CREATE TABLE FOLDERS ("
+    " ID INTEGER PRIMARY KEY,"
+    " PARENTID INTEGER,"
+    " FOLDERNAME TEXT);",
+
+    "CREATE TABLE DATA ("
+    " ID INTEGER PRIMARY KEY,"
+    " FOLDERID INTEGER,"
+    " MODULENAME TEXT,"
+    " KIND INTEGER,"
+    " DATASIZE INTEGER,"
+    " CREATEDDATE TEXT,"
+    " DATA BLOB,"
+    " PROFILE BLOB);"
+};
+
+// Indices are built after all records are inserted, it's much faster
+static const char *indexStatements[] = {
+    "CREATE INDEX FOLDERS_PARENTID ON FOLDERS (PARENTID);",
+    "CREATE INDEX DATA_FOLDERID ON DATA (FOLDERID);",
+    "CREATE INDEX DATA_KIND ON DATA (KIND, CREATEDDATE);"  // Filtered export
+};
+
+QStringList SqliteConverter::schema()
+{
+    QStringList statements;
+    for (const char *statement : schemaStatements)
+        statements.append(statement);
+    return statements;
+}
+
+QStringList SqliteConverter::indices()
+{
+    QStringList statements;
+    for (const char *statement : indexStatements)
+        statements.append(statement);
+    return statements;
+}
+
+SqliteConverter::SqliteConverter(StorageBackend *source, QObject *parent)
+    : QObject{parent},
+    m_source(source),
+    m_canceled(false),
+    m_count(0)
+{
+
+}
+
+bool SqliteConverter::convert(const QString &path)
+{
+    m_canceled = false;
+    m_count = 0;
+    m_lastErrorMsg.clear();
+
+    // Result appears under final name only when conversion is completed
+    const QString partPath = path + ".part";
+    QFile::remove(partPath);
+
+    bool ok = true;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(partPath);
+
+        if (!db.open()) {
+            m_lastErrorMsg = db.lastError().databaseText();
+            ok = false;
+        }
+
+        QSqlQuery query(db);
+        const QStringList schemaList = schema();
+        for (int i = 0; ok && (i < schemaList.count()); i++)
+            if (!query.exec(schemaList.at(i))) {
+                m_lastErrorMsg = query.lastError().databaseText();
+                ok = false;
+            }
+
+        if (ok) {
+            db.transaction();
+
+            QSqlQuery folderQuery(db);
+            folderQuery.prepare("INSERT INTO FOLDERS (ID, PARENTID, FOLDERNAME) VALUES (?, ?, ?)");
+
+            QSqlQuery dataQuery(db);
+            dataQuery.prepare("INSERT INTO DATA (ID, FOLDERID, MODULENAME, KIND, DATASIZE, CREATEDDATE, DATA, PROFILE) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+
+            // Root folder ID is 0
+            ok = convertFolder(&folderQuery, &dataQuery, 0);
+
+            if (ok)
+                ok = db.commit();
+            else
+                db.rollback();
+        }
+
+        const QStringList indexList = indices();
+        for (int i = 0; ok && (i < indexList.count()); i++)
+            if (!query.exec(indexList.at(i))) {
+                m_lastErrorMsg = query.lastError().databaseText();
+                ok = false;
+            }
+
+        query.clear();
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (ok) {
+        QFile::remove(path);
+        if (!QFile::rename(partPath, path)) {
+            m_lastErrorMsg = "Can't rename " + partPath;
+            ok = false;
+        }
+    }
+
+    if (!ok)
+        QFile::remove(partPath);
+
+    return ok;
+}
+
+bool SqliteConverter::convertFolder(QSqlQuery *folderQuery, QSqlQuery *dataQuery, int folderId)
+{
+    const QVector<FolderRecord> folders = m_source->folders(folderId);
+    for (const FolderRecord &folder : folders) {
+        folderQuery->addBindValue(folder.id);
+        folderQuery->addBindValue(folder.parentId);
+        folderQuery->addBindValue(folder.name);
+        if (!folderQuery->exec()) {
+            m_lastErrorMsg = folderQuery->lastError().databaseText();
+            return false;
+        }
+
+        // Recursion to convert subfolders
+        if (!convertFolder(folderQuery, dataQuery, folder.id))
+            return false;
+    }
+
+    const QVector<FileRecord> files = m_source->files(folderId);
+    for (const FileRecord &file : files) {
+        dataQuery->addBindValue(file.id);
+        dataQuery->addBindValue(file.folderId);
+        dataQuery->addBindValue(file.name);
+        dataQuery->addBindValue(file.kind);
+        dataQuery->addBindValue(file.size);
+        dataQuery->addBindValue(file.ctime.toString(Qt::ISODateWithMs));
+        dataQuery->addBindValue(m_source->blob(file.id, "DATA"));
+        dataQuery->addBindValue(m_source->blob(file.id, "PROFILE"));
+        if (!dataQuery->exec()) {
+            m_lastErrorMsg = dataQuery->lastError().databaseText();
+            return false;
+        }
+
+        emit progress(++m_count);
+
+        if (m_canceled) {
+            m_lastErrorMsg = "Conversion canceled.";
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,48 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef SQLITECONVERTER_H
+#define SQLITECONVERTER_H
+
+#include <QObject>
+#include <QtSql>
+#include "StorageBackend/StorageBackend.h"
+
+// One-time converter of an opened database into indexed SQLite mirror,
+// DATA & PROFILE BLOBs are copied as is (still zlib packed)
+class SqliteConverter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SqliteConverter(StorageBackend *source, QObject *parent = nullptr);
+
+    bool convert(const QString &path);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+    // Statements creating the mirror, Repacker writes the same schema
+    static QStringList schema();
+    // Indices are created after the tables are filled
+    static QStringList indices();
+
+public slots:
+    void cancel() { m_canceled = true; }
+
+signals:
+    // Number of records converted so far
+    void progress(int count);
+
+private:
+    StorageBackend *m_source;
+    QString m_lastErrorMsg;
+    bool m_canceled;
+    int m_count;
+
+    bool convertFolder(QSqlQuery *folderQuery, QSqlQuery *dataQuery, int folderId);
+};
+
+#endif // SQLITECONVERTER_H
@@ -0,0 +1,74 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef STORAGEBACKEND_H
+#define STORAGEBACKEND_H
+
+#include <QtCore>
+
+// FOLDERS table row
+struct FolderRecord
+{
+    int id;
+    int parentId;
+    QString name;
+};
+
+// DATA table row without BLOBs
+struct FileRecord
+{
+    int id;
+    int folderId;
+    int kind;
+    int size;
+    QString name;
+    QDateTime ctime;
+};
+
+// Conditions on DATA table rows, all set conditions must be met
+struct FileFilter
+{
+    QVector<int> kinds;     // KIND values, any kind if empty
+    QDateTime from, to;     // CREATEDDATE range, no limit if invalid
+    qint64 minSize = -1;    // DATASIZE range, no limit if negative
+    qint64 maxSize = -1;
+    QString name;           // MODULENAME wildcard pattern (* and ?), case insensitive
+    QVector<int> folderIds; // FOLDERID values, any folder if empty
+};
+
+// Storage interface behind SqlCore: gives access to ACE database tables
+// regardless of the engine the database file belongs to
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend() {}
+
+    virtual QString name() const = 0;
+    virtual bool open(const QString &path) = 0;
+    virtual void close() = 0;
+    virtual QString lastErrorMsg() const = 0;
+
+    // Subfolders of the folder, root folder ID is 0
+    virtual QVector<FolderRecord> folders(int parentId) = 0;
+    // Files of the folder
+    virtual QVector<FileRecord> files(int folderId) = 0;
+    // Page of the folder files: at most limit files with ID greater
+    // than afterId, in ID order. Returns false on error.
+    virtual bool files(int folderId, int afterId, int limit, QVector<FileRecord> *files) = 0;
+    // Files matching the filter, in no particular order. Returns false on error.
+    virtual bool findFiles(const FileFilter &filter, QVector<FileRecord> *files) = 0;
+    // BLOB field ("DATA" or "PROFILE") of the DATA table record. Returned data
+    // may reference backend memory, it stays valid until the backend is closed.
+    virtual QByteArray blob(int id, const QString &blobName) = 0;
+    // Sorts DATA record IDs in the order their BLOBs are stored in the file,
+    // so reading them one by one goes forward through the file. Records are
+    // mostly written in ID order, it is used if the storage is unknown.
+    virtual void sortByStorage(QVector<int> *ids) { std::sort(ids->begin(), ids->end()); }
+};
+
+#endif // STORAGEBACKEND_H
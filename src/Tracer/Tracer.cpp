@@ -0,0 +1,167 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Tracer.h"
+
+struct TraceEvent {
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+// Events and counters of one thread, owned by the global list and kept after
+// the thread exits. The lock is taken by its thread for every record and by
+// finish(), so it is almost never contended.
+struct ThreadEvents {
+    int tid;
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    QHash<const char*, qint64> counters;
+};
+
+QAtomicInt Tracer::s_session;
+
+static QMutex mutex;    // Guards the thread list and session start & finish
+static QString tracePath;
+static int lastSession = 0;
+static QList<ThreadEvents*> threads;
+static QAtomicInteger<qint64> traceOrigin;
+static thread_local ThreadEvents *localEvents = nullptr;
+
+static QElapsedTimer &traceClock()
+{
+    // Started once and never restarted, so now() is safe on any thread
+    static QElapsedTimer clock = []() { QElapsedTimer c; c.start(); return c; }();
+    return clock;
+}
+
+static ThreadEvents *threadEvents()
+{
+    if (!localEvents) {
+        QMutexLocker locker(&mutex);
+        localEvents = new ThreadEvents;
+        localEvents->tid = threads.count() + 1;
+        threads.append(localEvents);
+    }
+
+    return localEvents;
+}
+
+void Tracer::start(const QString &path)
+{
+    QMutexLocker locker(&mutex);
+
+    tracePath = path;
+    traceOrigin.storeRelaxed(traceClock().nsecsElapsed());
+    s_session.storeRelease(++lastSession);
+}
+
+void Tracer::count(const char *name, qint64 value)
+{
+    const int session = Tracer::session();
+    if (!session)
+        return;
+
+    ThreadEvents *thread = threadEvents();
+    QMutexLocker locker(&thread->mutex);
+
+    // Checked under the lock, finish() may have taken the counters already
+    if (s_session.loadAcquire() == session)
+        thread->counters[name] += value;
+}
+
+qint64 Tracer::now()
+{
+    return traceClock().nsecsElapsed() - traceOrigin.loadRelaxed();
+}
+
+void Tracer::record(const char *name, qint64 start, qint64 end, int session)
+{
+    ThreadEvents *thread = threadEvents();
+    QMutexLocker locker(&thread->mutex);
+
+    // Scope opened before finish() or before restart belongs to no trace
+    if (s_session.loadAcquire() == session)
+        thread->events.append({ name, start, end - start });
+}
+
+QString Tracer::finish(QString *errorMsg)
+{
+    QMutexLocker locker(&mutex);
+
+    // Threads stop recording once the session is reset
+    if (!s_session.fetchAndStoreAcquire(0))
+        return QString();
+
+    // Buffers are taken from the threads, their locks are held only for that
+    QVector<QPair<int, QVector<TraceEvent>>> events;
+    QMap<QByteArray, qint64> counters;
+    for (ThreadEvents *thread : qAsConst(threads)) {
+        QMutexLocker threadLocker(&thread->mutex);
+        events.append({ thread->tid, QVector<TraceEvent>() });
+        events.last().second.swap(thread->events);
+        for (auto it = thread->counters.cbegin(); it != thread->counters.cend(); ++it)
+            counters[it.key()] += it.value();
+        thread->counters.clear();
+    }
+
+    // Time per phase
+    QMap<QByteArray, QPair<qint64, qint64>> phases; // Calls and total time
+    for (const auto &thread : qAsConst(events))
+        for (const TraceEvent &event : thread.second) {
+            QPair<qint64, qint64> &phase = phases[event.name];
+            phase.first++;
+            phase.second += event.duration;
+        }
+
+    QFile f(tracePath);
+    if (f.open(QIODevice::WriteOnly)) {
+        QTextStream ts(&f);
+        ts << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+        for (const auto &thread : qAsConst(events))
+            for (const TraceEvent &event : thread.second) {
+                ts << (first ? "\n" : ",\n")
+                   << "{\"name\":\"" << event.name << "\",\"cat\":\"ace\",\"ph\":\"X\",\"pid\":1"
+                   << ",\"tid\":" << thread.first
+                   << ",\"ts\":" << QString::number(event.start / 1000.0, 'f', 3)
+                   << ",\"dur\":" << QString::number(event.duration / 1000.0, 'f', 3) << "}";
+                first = false;
+            }
+
+        // Counter totals at the end of the trace
+        for (auto it = counters.cbegin(); it != counters.cend(); ++it) {
+            ts << (first ? "\n" : ",\n")
+               << "{\"name\":\"" << it.key() << "\",\"ph\":\"C\",\"pid\":1"
+               << ",\"ts\":" << QString::number(now() / 1000.0, 'f', 3)
+               << ",\"args\":{\"value\":" << it.value() << "}}";
+            first = false;
+        }
+
+        ts << "\n]}\n";
+        ts.flush();
+
+        if ((ts.status() != QTextStream::Ok) && errorMsg)
+            *errorMsg = "Trace file writing error: " + f.errorString();
+    } else if (errorMsg)
+        *errorMsg = "Trace file creation error: " + f.errorString();
+
+    QString summary = QString("%1 %2 %3 %4\n").arg("Phase", -24).arg("Calls", 10).arg("Total ms", 12).arg("Avg us", 12);
+    for (auto it = phases.cbegin(); it != phases.cend(); ++it)
+        summary += QString("%1 %2 %3 %4\n")
+                       .arg(QString(it.key()), -24)
+                       .arg(it.value().first, 10)
+                       .arg(it.value().second / 1000000.0, 12, 'f', 2)
+                       .arg(it.value().second / 1000.0 / it.value().first, 12, 'f', 1);
+
+    for (auto it = counters.cbegin(); it != counters.cend(); ++it)
+        summary += QString("%1 %2\n").arg(QString(it.key()), -24).arg(it.value(), 10);
+
+    return summary;
+}
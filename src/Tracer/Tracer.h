@@ -0,0 +1,63 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QtCore>
+
+// Run-time switchable tracing of hot paths. Scopes are collected into
+// per-thread buffers and written as Chrome trace JSON (chrome://tracing,
+// ui.perfetto.dev), counters and time per phase are given as a summary.
+// When tracing is off, a scope costs one atomic load. Every start() begins
+// a new session, scopes still open from the previous one are dropped.
+class Tracer
+{
+public:
+    // Starts collecting, trace file is written by finish()
+    static void start(const QString &path);
+    static bool isEnabled() { return s_session.loadRelaxed() != 0; }
+    // Current session, 0 when tracing is off
+    static int session() { return s_session.loadAcquire(); }
+
+    // Adds value to a named counter, name must be a string literal
+    static void count(const char *name, qint64 value = 1);
+
+    // Stops collecting, writes trace file and returns summary table,
+    // to be called when traced work is done. Error message is set if
+    // the trace file can't be written.
+    static QString finish(QString *errorMsg = nullptr);
+
+    // Nanoseconds since start()
+    static qint64 now();
+    // Records a finished scope of the session, name must be a string literal
+    static void record(const char *name, qint64 start, qint64 end, int session);
+
+private:
+    static QAtomicInt s_session;
+};
+
+// Times the enclosing block
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : m_session(Tracer::session()),
+        m_name(m_session ? name : nullptr),
+        m_start(m_name ? Tracer::now() : 0) {}
+    ~TraceScope() { if (m_name) Tracer::record(m_name, m_start, Tracer::now(), m_session); }
+
+private:
+    int m_session;
+    const char *m_name;
+    qint64 m_start;
+};
+
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+
+#endif // TRACER_H
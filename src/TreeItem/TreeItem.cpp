@@ -11,10 +11,14 @@
 TreeItem::TreeItem(int id, const QString &name, TreeItem *parentItem) :
     m_parentItem(parentItem),
     m_id(id),
+    m_size(0),
+    m_type(RawData),
     m_name(name),
-    m_folder(true) // Item is a folder!
+    m_folder(true), // Item is a folder!
+    m_aggregate(new Aggregate),
+    m_moreFiles(false)
 {
-
+    m_aggregate->reset();
 }
 
 TreeItem::TreeItem(int id, int size, DataType type, const QString &name, const QDateTime &ctime, TreeItem *parentItem) :
@@ -24,7 +28,9 @@ TreeItem::TreeItem(int id, int size, DataType type, const QString &name, const Q
     m_type(type),
     m_name(name),
     m_ctime(ctime),
-    m_folder(false) // Item is a file!
+    m_folder(false), // Item is a file!
+    m_aggregate(nullptr),
+    m_moreFiles(false)
 {
 
 }
@@ -32,6 +38,120 @@ TreeItem::TreeItem(int id, int size, DataType type, const QString &name, const Q
 TreeItem::~TreeItem()
 {
     qDeleteAll(m_childItems);
+    delete m_aggregate;
+}
+
+void TreeItem::append(TreeItem *child)
+{
+    m_childItems.append(child);
+    child->m_parentItem = this;
+
+    if (!m_aggregate)
+        return;
+
+    // Incremental update of this folder and all its parents
+    const Aggregate delta = child->contribution();
+    for (TreeItem *item = this; item && item->m_aggregate; item = item->m_parentItem)
+        item->m_aggregate->merge(delta);
+}
+
+void TreeItem::clear()
+{
+    qDeleteAll(m_childItems);
+    m_childItems.clear();
+    m_moreFiles = false;
+
+    if (!m_aggregate)
+        return;
+
+    m_aggregate->reset();
+    recountParents();
+}
+
+void TreeItem::setMoreFiles(bool more)
+{
+    if (!m_aggregate || (m_moreFiles == more))
+        return;
+
+    m_moreFiles = more;
+
+    for (TreeItem *item = this; item && item->m_aggregate; item = item->m_parentItem)
+        item->m_aggregate->partialCount += more ? 1 : -1;
+}
+
+TreeItem *TreeItem::take(int row)
+{
+    if ((row < 0) || (row >= m_childItems.count()))
+        return nullptr;
+
+    TreeItem *child = m_childItems.takeAt(row);
+    child->m_parentItem = nullptr;
+
+    if (m_aggregate) {
+        recount();
+        recountParents();
+    }
+
+    return child;
+}
+
+void TreeItem::recount()
+{
+    m_aggregate->reset();
+    for (TreeItem *child : qAsConst(m_childItems))
+        m_aggregate->merge(child->contribution());
+    if (m_moreFiles)
+        m_aggregate->partialCount++;
+}
+
+void TreeItem::recountParents()
+{
+    // Time range can't be subtracted, so parents are recounted from their children
+    for (TreeItem *item = m_parentItem; item && item->m_aggregate; item = item->m_parentItem)
+        item->recount();
+}
+
+TreeItem::Aggregate TreeItem::contribution()
+{
+    Aggregate result;
+
+    if (m_folder) {
+        result = *m_aggregate;
+        result.folderCount++;
+        return result;
+    }
+
+    result.reset();
+    result.totalSize = m_size;
+    result.fileCount = 1;
+    result.kinds[((m_type >= 0) && (m_type < KIND_COUNT - 1)) ? m_type : KIND_COUNT - 1] = 1;
+    if (m_ctime.isValid())
+        result.oldest = result.newest = m_ctime.toMSecsSinceEpoch();
+
+    return result;
+}
+
+void TreeItem::Aggregate::reset()
+{
+    totalSize = 0;
+    fileCount = 0;
+    folderCount = 0;
+    memset(kinds, 0, sizeof(kinds));
+    oldest = std::numeric_limits<qint64>::max();
+    newest = std::numeric_limits<qint64>::min();
+    partialCount = 0;
+}
+
+void TreeItem::Aggregate::merge(const Aggregate &other)
+{
+    totalSize += other.totalSize;
+    fileCount += other.fileCount;
+    folderCount += other.folderCount;
+    for (int i = 0; i < KIND_COUNT; i++)
+        kinds[i] += other.kinds[i];
+    oldest = qMin(oldest, other.oldest);
+    newest = qMax(newest, other.newest);
+    partialCount += other.partialCount;
 }
 
 int TreeItem::row()
@@ -47,7 +167,8 @@ QStringList TreeItem::headers()
     return QStringList() << "Name"
                          << "Size"
                          << "Data type"
-                         << "Creation time";
+                         << "Creation time"
+                         << "Files";
 }
 
 QString TreeItem::DataTypeToText(DataType type)
@@ -81,6 +202,19 @@ QVariant TreeItem::data(int column)
         switch (column) {
         case 0:
             return m_name;
+        case 1:
+            // "+" for folders loaded partially
+            return QString::number(m_aggregate->totalSize) + (m_aggregate->partialCount ? "+" : "");
+        case 2:
+            return kindsToText();
+        case 3:
+            if (m_aggregate->oldest > m_aggregate->newest)
+                return QVariant();
+            return QString("%1 - %2")
+                .arg(QDateTime::fromMSecsSinceEpoch(m_aggregate->oldest).toString("yyyy.MM.dd hh:mm:ss"))
+                .arg(QDateTime::fromMSecsSinceEpoch(m_aggregate->newest).toString("yyyy.MM.dd hh:mm:ss"));
+        case 4:
+            return QString::number(m_aggregate->fileCount) + (m_aggregate->partialCount ? "+" : "");
 
         default:
             return QVariant();
@@ -100,3 +234,21 @@ QVariant TreeItem::data(int column)
             return QVariant();
         }
 }
+
+QString TreeItem::kindsToText()
+{
+    // Most common data types first
+    QVector<QPair<int, int>> kinds;
+    for (int i = 0; i < KIND_COUNT; i++)
+        if (m_aggregate->kinds[i])
+            kinds.append({ m_aggregate->kinds[i], i });
+
+    std::sort(kinds.begin(), kinds.end(),
+              [](const QPair<int, int> &a, const QPair<int, int> &b) { return a.first > b.first; });
+
+    QStringList list;
+    for (const QPair<int, int> &kind : qAsConst(kinds))
+        list.append(QString("%1: %2").arg(DataTypeToText((DataType)kind.second)).arg(kind.first));
+
+    return list.join(", ");
+}
@@ -16,6 +16,23 @@ class TreeItem
 public:
     enum DataType { RawData, Firmware, RomDump, RamDump, Adaptives, Track, Text, InternalData };
 
+    // Number of histogram buckets, the last one is for unknown data types
+    static const int KIND_COUNT = InternalData + 2;
+
+    // Recursive statistics of a folder, kept current by append() and clear()
+    struct Aggregate {
+        qint64 totalSize;       // Total size of files in bytes
+        int fileCount;
+        int folderCount;
+        int kinds[KIND_COUNT];  // Number of files of each data type
+        qint64 oldest;          // Creation time range, ms since epoch,
+        qint64 newest;          // oldest > newest if no file has valid time
+        int partialCount;       // Folders with files not loaded yet, this one included
+
+        void reset();
+        void merge(const Aggregate &other);
+    };
+
     // Creates new folder item
     explicit TreeItem(int id,
                       const QString &name,
@@ -29,8 +46,13 @@ public:
                       TreeItem *parentItem);
     ~TreeItem();
 
-    // Appends a child item
-    void append(TreeItem *child) { m_childItems.append(child); };
+    // Appends a child item (also one created without parent),
+    // statistics of all parent folders are updated
+    void append(TreeItem *child);
+    // Detaches a child item without deleting it, nullptr for a wrong row
+    TreeItem *take(int row);
+    // Deletes all child items
+    void clear();
 
     TreeItem *childItem(int row) { return m_childItems.value(row, nullptr); }
     TreeItem *parentItem() { return m_parentItem; }
@@ -45,6 +67,13 @@ public:
     QDateTime ctime() { return m_ctime; }
     bool isFoler() { return m_folder; }
 
+    // Folder statistics, nullptr for files
+    const Aggregate *aggregate() { return m_aggregate; }
+
+    // Folder has files not loaded yet (see SqlCore::fetchFiles())
+    bool hasMoreFiles() { return m_moreFiles; }
+    void setMoreFiles(bool more);
+
     static QStringList headers();
     static QString DataTypeToText(DataType type);
     QVariant data(int column);
@@ -59,6 +88,17 @@ private:
     QString m_name;     // File or folder name
     QDateTime m_ctime;  // File creation time
     bool m_folder;      // Is this item file or folder?
+    Aggregate *m_aggregate; // Folder statistics, files have none
+    bool m_moreFiles;   // Folder is loaded partially
+
+    // Statistics this item adds to its parent folder
+    Aggregate contribution();
+    // Recounts statistics of the folder from its children
+    void recount();
+    // Recounts statistics of all parent folders
+    void recountParents();
+    // Data type histogram as text
+    QString kindsToText();
 };
 
 #endif // TREEITEM_H
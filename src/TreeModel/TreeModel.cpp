@@ -21,6 +21,27 @@ void TreeModel::setRootItem(TreeItem *item)
     endResetModel();
 }
 
+void TreeModel::appendItem(TreeItem *item)
+{
+    const int row = m_rootItem->childCount();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_rootItem->append(item);
+    endInsertRows();
+}
+
+TreeItem *TreeModel::takeItem(int row)
+{
+    if ((row < 0) || (row >= m_rootItem->childCount()))
+        return nullptr;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    TreeItem *item = m_rootItem->take(row);
+    endRemoveRows();
+
+    return item;
+}
+
 QModelIndex TreeModel::index(int row, int column, const QModelIndex &parent) const
 {
     if (!hasIndex(row, column, parent))
@@ -140,3 +161,69 @@ Qt::ItemFlags TreeModel::flags(const QModelIndex &index) const
 
     return QAbstractItemModel::flags(index);
 }
+
+bool TreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid() || !m_fetcher)
+        return false;
+
+    return static_cast<TreeItem*>(parent.internalPointer())->hasMoreFiles();
+}
+
+void TreeModel::fetchMore(const QModelIndex &parent)
+{
+    // Failed page is tried again when the view asks for more
+    fetchPage(parent);
+}
+
+bool TreeModel::fetchPage(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return true;
+
+    TreeItem *folder = static_cast<TreeItem*>(parent.internalPointer());
+    QVector<TreeItem*> items;
+    if (!m_fetcher(folder, &items))
+        return false;
+
+    if (!items.isEmpty()) {
+        const int row = folder->childCount();
+        beginInsertRows(parent, row, row + items.count() - 1);
+        for (TreeItem *item : items)
+            folder->append(item);
+        endInsertRows();
+    }
+
+    // Statistics of the folder and its parents have changed
+    for (TreeItem *item = folder; item && (item != m_rootItem); item = item->parentItem())
+        emit dataChanged(indexOf(item, 1), indexOf(item, columnCount(QModelIndex()) - 1));
+
+    return true;
+}
+
+bool TreeModel::fetchAll(TreeItem *parentItem)
+{
+    const TreeItem::Aggregate *aggregate = parentItem->aggregate();
+
+    if (!aggregate || !aggregate->partialCount)
+        return true;
+
+    const QModelIndex parent = indexOf(parentItem);
+    while (canFetchMore(parent))
+        if (!fetchPage(parent))
+            return false;
+
+    for (int i = 0; i < parentItem->childCount(); i++)
+        if (!fetchAll(parentItem->childItem(i)))
+            return false;
+
+    return true;
+}
+
+QModelIndex TreeModel::indexOf(TreeItem *item, int column) const
+{
+    if (!item || (item == m_rootItem))
+        return QModelIndex();
+
+    return createIndex(item->row(), column, item);
+}
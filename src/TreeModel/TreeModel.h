@@ -10,6 +10,7 @@
 #define TREEMODEL_H
 
 #include <QAbstractItemModel>
+#include <functional>
 #include "TreeItem/TreeItem.h"
 
 class TreeModel : public QAbstractItemModel
@@ -19,6 +20,17 @@ public:
     explicit TreeModel(QObject *parent = nullptr);
 
     void setRootItem(TreeItem *item);
+    // Adds top level item to the root item
+    void appendItem(TreeItem *item);
+    // Removes top level item, it is not deleted
+    TreeItem *takeItem(int row);
+
+    // Gives next page of files of the folder loaded partially, returns false
+    // on error, see SqlCore::fetchFiles()
+    typedef std::function<bool(TreeItem *folder, QVector<TreeItem*> *items)> Fetcher;
+    void setFetcher(const Fetcher &fetcher) { m_fetcher = fetcher; }
+    // Loads all files of the subtree not loaded yet, returns false on error
+    bool fetchAll(TreeItem *parentItem);
 
     // QAbstractItemModel interface
     QModelIndex index(int row, int column, const QModelIndex &parent) const override;
@@ -28,9 +40,15 @@ public:
     QVariant data(const QModelIndex &index, int role) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
 private:
     TreeItem *m_rootItem;
+    Fetcher m_fetcher;
+
+    QModelIndex indexOf(TreeItem *item, int column = 0) const;
+    bool fetchPage(const QModelIndex &parent);
 };
 
 #endif // TREEMODEL_H
@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "UringFileWriter.h"
+#include <fcntl.h>
+
+// Completion tag is slot number and operation
+static inline void *tag(int slot, int operation)
+{
+    return (void *)(quintptr)(slot * 4 + operation);
+}
+
+UringFileWriter::UringFileWriter()
+    : m_ready(false),
+    m_ok(true),
+    m_queued(0)
+{
+    // Every file needs three submission entries
+    if (io_uring_queue_init(SLOTS * 3, &m_ring, 0) < 0)
+        return;
+
+    // Sparse table of direct descriptors, filled by openat
+    int fds[SLOTS];
+    for (int i = 0; i < SLOTS; i++) {
+        fds[i] = -1;
+        m_freeSlots.append(i);
+    }
+
+    if (io_uring_register_files(&m_ring, fds, SLOTS) < 0) {
+        io_uring_queue_exit(&m_ring);
+        return;
+    }
+
+    m_ready = true;
+}
+
+UringFileWriter::~UringFileWriter()
+{
+    if (!m_ready)
+        return;
+
+    finish();
+    io_uring_queue_exit(&m_ring);
+}
+
+bool UringFileWriter::write(const QString &path, const QByteArray &data)
+{
+    // Only files with holes are written with seeks, the rest stay on the ring
+    if ((data.size() > MAX_FILE_SIZE) || hasHole(data))
+        return writeFile(path, data);
+
+    countFill(data);
+
+    while (m_freeSlots.isEmpty())
+        reap(true);
+
+    const int slot = m_freeSlots.takeLast();
+    Request &request = m_requests[slot];
+    request.path = QFile::encodeName(path);
+    request.data = data;
+    request.pending = 3;
+    request.ok = true;
+
+    io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+    io_uring_prep_openat_direct(sqe, AT_FDCWD, request.path.constData(),
+                                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644, slot);
+    io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+    io_uring_sqe_set_data(sqe, tag(slot, OpenOperation));
+
+    // Hard link: the slot is closed even if the write fails
+    sqe = io_uring_get_sqe(&m_ring);
+    io_uring_prep_write(sqe, slot, request.data.constData(), request.data.size(), 0);
+    io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK);
+    io_uring_sqe_set_data(sqe, tag(slot, WriteOperation));
+
+    sqe = io_uring_get_sqe(&m_ring);
+    io_uring_prep_close_direct(sqe, slot);
+    io_uring_sqe_set_data(sqe, tag(slot, CloseOperation));
+
+    if (++m_queued >= SUBMIT_BATCH) {
+        io_uring_submit(&m_ring);
+        m_queued = 0;
+    }
+
+    // Free slots of completed files without waiting
+    reap(false);
+
+    return true;
+}
+
+bool UringFileWriter::finish()
+{
+    while (m_freeSlots.count() < SLOTS)
+        reap(true);
+
+    const bool ok = m_ok;
+    m_ok = true;
+
+    return ok;
+}
+
+void UringFileWriter::reap(bool wait)
+{
+    if (wait) {
+        io_uring_submit_and_wait(&m_ring, 1);
+        m_queued = 0;
+    }
+
+    io_uring_cqe *cqe;
+
+    while (io_uring_peek_cqe(&m_ring, &cqe) == 0) {
+        const quintptr value = (quintptr)io_uring_cqe_get_data(cqe);
+        const int slot = value / 4;
+        const int operation = value % 4;
+        const int result = cqe->res;
+        io_uring_cqe_seen(&m_ring, cqe);
+
+        Request &request = m_requests[slot];
+
+        if (operation == WriteOperation) {
+            if (result != request.data.size())
+                request.ok = false;
+        } else if (result < 0)
+            request.ok = false;
+
+        if (--request.pending == 0) {
+            if (!request.ok)
+                m_ok = false;
+            request.path.clear();
+            request.data.clear();
+            m_freeSlots.append(slot);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef URINGFILEWRITER_H
+#define URINGFILEWRITER_H
+
+#include "FileWriter/FileWriter.h"
+#include <liburing.h>
+
+// Linux io_uring writer for many small files. Every file is a linked chain
+// of openat, write and close on a registered (direct) file slot, so no file
+// descriptor comes back to user space and a batch of chains costs a single
+// system call. Large files are written synchronously, they are limited by
+// bandwidth, not latency, so are files with a zero run of MIN_HOLE bytes
+// or more (see hasHole()), the ring writes data as is, without holes.
+// Needs kernel 5.15+, built with CONFIG+=liburing.
+class UringFileWriter : public FileWriter
+{
+public:
+    enum {
+        SLOTS = 64,                 // Files in flight
+        SUBMIT_BATCH = 16,          // Files per submit
+        MAX_FILE_SIZE = 0x100000    // Larger files go through QFile
+    };
+
+    UringFileWriter();
+    ~UringFileWriter();
+
+    // False if io_uring or direct descriptors are not supported
+    bool isReady() const { return m_ready; }
+
+    QString name() const override { return "uring"; }
+    bool write(const QString &path, const QByteArray &data) override;
+    bool finish() override;
+
+private:
+    enum Operation { OpenOperation, WriteOperation, CloseOperation };
+
+    struct Request {
+        QByteArray path;    // Must live until openat is completed
+        QByteArray data;    // Must live until write is completed
+        int pending;        // Operations not completed yet
+        bool ok;
+    };
+
+    io_uring m_ring;
+    bool m_ready;
+    bool m_ok;
+    int m_queued;           // Files queued since the last submit
+    Request m_requests[SLOTS];
+    QVector<int> m_freeSlots;
+
+    void reap(bool wait);
+};
+
+#endif // URINGFILEWRITER_H
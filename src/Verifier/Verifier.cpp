@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Verifier.h"
+#include "ProfileItem/ProfileItem.h"
+#include <QtEndian>
+#include "BatchPipeline/BatchPipeline.h"
+#include "InflateContext/InflateContext.h"
+
+struct VerifyJob {
+    TreeItem *item;
+    QByteArray data;
+    QByteArray profile;
+    QStringList messages;
+};
+
+static void checkData(VerifyJob &job)
+{
+    if (job.data.size() < (int)sizeof(quint32)) {
+        job.messages.append("no data");
+        return;
+    }
+
+    const quint32 length = qFromLittleEndian<quint32>(job.data.constData());
+    if (length != (quint32)job.item->size())
+        job.messages.append(QString("length prefix is %1 bytes, DATASIZE is %2 bytes")
+                                .arg(length)
+                                .arg(job.item->size()));
+
+    // Whole stream is inflated chunk by chunk, zlib checks adler32 at the end
+    QString errorMsg;
+    const qint64 inflated = InflateContext::local()->streamBlob(job.data, nullptr, &errorMsg);
+
+    if (inflated < 0)
+        job.messages.append(errorMsg);
+    else if (inflated != length)
+        job.messages.append(QString("inflated %1 bytes, length prefix is %2 bytes")
+                                .arg(inflated)
+                                .arg(length));
+}
+
+static void checkProfile(VerifyJob &job)
+{
+    // Files without profile are not a problem
+    if (job.profile.isEmpty())
+        return;
+
+    QVector<ProfileItem> items;
+    const int count = ProfileItem::parse(job.profile, &items);
+
+    if (count < 0)
+        job.messages.append(QString("profile parse error %1").arg(count));
+    else if (count != items.count())
+        job.messages.append(QString("profile has %1 of %2 items").arg(items.count()).arg(count));
+}
+
+static void verifyJob(VerifyJob &job)
+{
+    checkData(job);
+    checkProfile(job);
+
+    // Don't keep BLOBs until the batch is collected
+    job.data.clear();
+    job.profile.clear();
+}
+
+Verifier::Verifier(SqlCore *sqlCore, QObject *parent)
+    : QObject{parent},
+    m_sqlCore(sqlCore),
+    m_checkedCount(0),
+    m_canceled(false)
+{
+
+}
+
+bool Verifier::verify(TreeItem *parentItem)
+{
+    m_problems.clear();
+    m_checkedCount = 0;
+    m_canceled = false;
+    m_lastErrorMsg.clear();
+
+    QVector<QPair<TreeItem*, QString>> files;
+    BatchPipeline::collectFiles(parentItem, QString(), &files);
+
+    if (files.isEmpty())
+        return true;
+
+    StorageBackend *backend = m_sqlCore->backend();
+    if (!backend) {
+        m_lastErrorMsg = m_sqlCore->lastErrorMsg();
+        return false;
+    }
+
+    auto fetch = [&](int index, VerifyJob &job) {
+        job.item = files.at(index).first;
+        job.data = backend->blob(job.item->id(), "DATA");
+        job.profile = backend->blob(job.item->id(), "PROFILE");
+        return (qint64)job.data.size() + job.profile.size();
+    };
+
+    auto done = [&](const QVector<VerifyJob> &batch, int first) {
+        for (int i = 0; i < batch.count(); i++) {
+            const VerifyJob &job = batch.at(i);
+            if (!job.messages.isEmpty())
+                m_problems.append({ job.item, files.at(first + i).second, job.messages.join("; ") });
+        }
+
+        m_checkedCount += batch.count();
+        emit progress(m_checkedCount, files.count());
+
+        if (m_canceled) {
+            m_lastErrorMsg = "Canceled by user.";
+            return false;
+        }
+
+        return true;
+    };
+
+    return BatchPipeline::run(files.count(), fetch, verifyJob, done);
+}
+    return true;
+}
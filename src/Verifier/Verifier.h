@@ -0,0 +1,53 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <QObject>
+#include "SqlCore/SqlCore.h"
+#include "TreeItem/TreeItem.h"
+
+// Read-only integrity check of every file of the database: length prefix
+// against DATASIZE, zlib stream with its adler32 and PROFILE structure.
+// BLOBs are fetched on the calling thread and checked on the thread pool.
+class Verifier : public QObject
+{
+    Q_OBJECT
+public:
+    struct Problem {
+        TreeItem *item;
+        QString path;
+        QString message;
+    };
+
+    explicit Verifier(SqlCore *sqlCore, QObject *parent = nullptr);
+
+    // Verifies all files under the parent item, returns false on database
+    // error or cancel, found problems are not errors
+    bool verify(TreeItem *parentItem);
+    QString lastErrorMsg() const { return m_lastErrorMsg; }
+
+    const QVector<Problem> &problems() const { return m_problems; }
+    int checkedCount() const { return m_checkedCount; }
+
+signals:
+    void progress(int done, int total);
+
+public slots:
+    void cancel() { m_canceled = true; }
+
+private:
+    SqlCore *m_sqlCore;
+    QVector<Problem> m_problems;
+    int m_checkedCount;
+    bool m_canceled;
+    QString m_lastErrorMsg;
+};
+
+#endif // VERIFIER_H
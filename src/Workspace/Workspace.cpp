@@ -0,0 +1,219 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "Workspace.h"
+#include <QtConcurrent>
+
+static bool samePath(const QString &a, const QString &b)
+{
+    return QFileInfo(a).absoluteFilePath() == QFileInfo(b).absoluteFilePath();
+}
+
+Workspace::Workspace(TreeModel *model, QObject *parent)
+    : QObject{parent},
+    m_model(model),
+    m_rootItem(new TreeItem(-1, "ROOT", nullptr)), // Hidden in TreeView
+    m_settings(new SqlCore(this))
+{
+    m_model->setRootItem(m_rootItem);
+
+    // Huge folders are loaded page by page when expanded
+    m_settings->setPageSize(PAGE_SIZE);
+    m_model->setFetcher([this](TreeItem *folder, QVector<TreeItem*> *items) {
+        SqlCore *sqlCore = this->sqlCore(folder);
+        return sqlCore && sqlCore->fetchFiles(folder, items);
+    });
+}
+
+Workspace::~Workspace()
+{
+    m_model->setRootItem(nullptr);
+    m_model->setFetcher(nullptr);
+
+    // Catalog loaders can't be interrupted
+    for (Database *database : qAsConst(m_databases)) {
+        if (database->loader) {
+            database->loader->waitForFinished();
+            delete database->item;
+        }
+        delete database;
+    }
+
+    // Loaded databases are in the tree
+    delete m_rootItem;
+}
+
+void Workspace::setCredentials(const QString &user, const QString &password)
+{
+    m_settings->setCredentials(user, password);
+}
+
+void Workspace::setEngine(SqlCore::Engine engine)
+{
+    m_settings->setEngine(engine);
+}
+
+bool Workspace::setInflateEngine(const QString &name)
+{
+    return m_settings->setInflateEngine(name);
+}
+
+bool Workspace::open(const QString &path)
+{
+    for (const Database *database : qAsConst(m_databases))
+        if (samePath(database->path, path))
+            return false;
+
+    Database *database = new Database;
+    database->path = path;
+    database->sqlCore = new SqlCore(this);
+    database->sqlCore->copySettings(m_settings);
+    // Item is named as file name
+    database->item = new TreeItem(0, QFileInfo(path).completeBaseName(), nullptr);
+    database->loader = new QFutureWatcher<bool>(this);
+    database->recordLoader = nullptr;
+    m_databases.append(database);
+
+    connect(database->loader, &QFutureWatcher<bool>::finished, this, [this, database]() {
+        loaded(database);
+    });
+
+    // Loader has its own connection, the database connection
+    // of the workspace is opened later in the GUI thread. Settings
+    // are copied here, the GUI thread may change them meanwhile.
+    SqlCore *loader = new SqlCore;
+    loader->copySettings(m_settings);
+    database->loader->setFuture(QtConcurrent::run([database, loader]() {
+        const bool ok = loader->load(database->path, database->item);
+        if (!ok)
+            database->errorMsg = loader->lastErrorMsg();
+        // Connection must be closed by the thread it was used in
+        delete loader;
+        return ok;
+    }));
+
+    return true;
+}
+
+void Workspace::loaded(Database *database)
+{
+    const bool ok = database->loader->result();
+    database->loader->deleteLater();
+    database->loader = nullptr;
+
+    if (!ok) {
+        m_databases.removeOne(database);
+        const QString path = database->path;
+        const QString errorMsg = database->errorMsg;
+        delete database->item;
+        delete database->sqlCore;
+        delete database;
+        emit failed(path, errorMsg);
+        return;
+    }
+
+    database->sqlCore->openLater(database->path);
+    database->sqlCore->count(database->item);
+    m_model->appendItem(database->item);
+
+    emit opened(database->item);
+}
+
+void Workspace::close(TreeItem *databaseItem)
+{
+    Database *database = this->database(databaseItem);
+
+    if (!database || database->loader)
+        return;
+
+    m_databases.removeOne(database);
+    delete m_model->takeItem(database->item->row());
+    delete database->recordLoader;
+    delete database->sqlCore;
+    delete database;
+}
+
+Workspace::Database *Workspace::database(TreeItem *item) const
+{
+    TreeItem *top = databaseItem(item);
+
+    for (Database *database : m_databases)
+        if (database->item == top)
+            return database;
+
+    return nullptr;
+}
+
+TreeItem *Workspace::databaseItem(TreeItem *item) const
+{
+    while (item && item->parentItem() && (item->parentItem() != m_rootItem))
+        item = item->parentItem();
+
+    return item;
+}
+
+SqlCore *Workspace::sqlCore(TreeItem *item) const
+{
+    Database *database = this->database(item);
+    return database ? database->sqlCore : nullptr;
+}
+
+RecordLoader *Workspace::recordLoader(TreeItem *item)
+{
+    Database *database = this->database(item);
+
+    if (!database || database->loader)
+        return nullptr;
+
+    // Has its own connection, so records are loaded while the GUI thread
+    // uses the database connection of the workspace
+    if (!database->recordLoader)
+        database->recordLoader = new RecordLoader(database->sqlCore, database->path, this);
+
+    return database->recordLoader;
+}
+
+QString Workspace::path(TreeItem *item) const
+{
+    Database *database = this->database(item);
+    return database ? database->path : QString();
+}
+
+TreeItem *Workspace::find(const QString &path) const
+{
+    for (Database *database : m_databases)
+        if (!database->loader && samePath(database->path, path))
+            return database->item;
+
+    return nullptr;
+}
+
+bool Workspace::contains(TreeItem *databaseItem) const
+{
+    for (Database *database : m_databases)
+        if (!database->loader && (database->item == databaseItem))
+            return true;
+
+    return false;
+}
+
+int Workspace::count() const
+{
+    return m_databases.count() - loadingCount();
+}
+
+int Workspace::loadingCount() const
+{
+    int result = 0;
+
+    for (Database *database : m_databases)
+        if (database->loader)
+            result++;
+
+    return result;
+}
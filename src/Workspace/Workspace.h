@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include "SqlCore/SqlCore.h"
+#include "TreeModel/TreeModel.h"
+#include "RecordLoader/RecordLoader.h"
+
+// Several databases open at once, shown as sibling top level items of the
+// tree model. Every database has its own connection, catalog is loaded in
+// background. Inflated data of all databases shares RecordCache.
+class Workspace : public QObject
+{
+    Q_OBJECT
+public:
+    // Files of a folder loaded at once, the rest is fetched by TreeModel
+    static const int PAGE_SIZE = 1000;
+
+    explicit Workspace(TreeModel *model, QObject *parent = nullptr);
+    ~Workspace();
+
+    // Connection settings for databases opened later
+    void setCredentials(const QString &user, const QString &password);
+    void setEngine(SqlCore::Engine engine);
+    bool setInflateEngine(const QString &name);
+    QString inflateEngine() const { return m_settings->inflateEngine(); }
+
+    // Starts catalog loading in background, opened() or failed() is emitted
+    // when it is done. Returns false if the database is already open or loading.
+    bool open(const QString &path);
+    // Removes database from the tree and deletes its items
+    void close(TreeItem *databaseItem);
+
+    // Top level item of the database the item belongs to
+    TreeItem *databaseItem(TreeItem *item) const;
+    // Database of the item, nullptr if there is none
+    SqlCore *sqlCore(TreeItem *item) const;
+    // Background BLOB loader of the database, created on the first call.
+    // nullptr if there is no such database.
+    RecordLoader *recordLoader(TreeItem *item);
+    QString path(TreeItem *item) const;
+    // Top level item of the database open from the file, nullptr if there is none
+    TreeItem *find(const QString &path) const;
+    // True if the item is top level item of an open database
+    bool contains(TreeItem *databaseItem) const;
+
+    int count() const;
+    int loadingCount() const;
+
+signals:
+    void opened(TreeItem *databaseItem);
+    void failed(const QString &path, const QString &errorMsg);
+
+private:
+    struct Database {
+        QString path;
+        SqlCore *sqlCore;
+        TreeItem *item;                 // Not in the tree while loading
+        QFutureWatcher<bool> *loader;   // nullptr when loaded
+        QString errorMsg;               // Set by the loader
+        RecordLoader *recordLoader;     // nullptr until records are viewed
+    };
+
+    TreeModel *m_model;
+    TreeItem *m_rootItem;
+    SqlCore *m_settings;    // Settings for new connections
+    QList<Database*> m_databases;
+
+    Database *database(TreeItem *item) const;
+    void loaded(Database *database);
+};
+
+#endif // WORKSPACE_H
@@ -0,0 +1,43 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "ZlibInflater.h"
+
+ZlibInflater::ZlibInflater()
+    : m_streamReady(false)
+{
+    memset(&m_stream, 0, sizeof(m_stream));
+}
+
+ZlibInflater::~ZlibInflater()
+{
+    if (m_streamReady)
+        inflateEnd(&m_stream);
+}
+
+qint64 ZlibInflater::inflate(const char *in, qint64 inSize, char *out, qint64 outSize)
+{
+    // inflateReset() keeps the window and state allocated by inflateInit()
+    int err = m_streamReady ? inflateReset(&m_stream) : inflateInit(&m_stream);
+    m_streamReady = (err == Z_OK);
+
+    if (!m_streamReady)
+        return -1;
+
+    m_stream.next_in = (Bytef *)in;
+    m_stream.avail_in = inSize;
+    m_stream.next_out = (Bytef *)out;
+    m_stream.avail_out = outSize;
+
+    err = ::inflate(&m_stream, Z_FINISH);
+
+    if (err != Z_STREAM_END)
+        return -1;
+
+    return outSize - m_stream.avail_out;
+}
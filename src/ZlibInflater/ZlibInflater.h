@@ -0,0 +1,31 @@
+/****************************************************************************
+**
+** This file is part of the Ace Database Viewer project.
+** Copyright (C) 2024 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef ZLIBINFLATER_H
+#define ZLIBINFLATER_H
+
+#include "Inflater/Inflater.h"
+#include <QtZlib/zlib.h>
+
+// Stock zlib (QtZlib) decoder, inflate state is allocated once and reset
+// for every next stream
+class ZlibInflater : public Inflater
+{
+public:
+    ZlibInflater();
+    ~ZlibInflater();
+
+    QString name() const override { return "zlib"; }
+    qint64 inflate(const char *in, qint64 inSize, char *out, qint64 outSize) override;
+
+private:
+    z_stream m_stream;
+    bool m_streamReady;
+};
+
+#endif // ZLIBINFLATER_H
@@ -1,4 +1,4 @@
-QT       += core gui sql
+QT       += core gui sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,27 +9,119 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    BatchPipeline/BatchPipeline.cpp \
+    CatalogCache/CatalogCache.cpp \
+    CatalogWriter/CatalogWriter.cpp \
+    Console/Console.cpp \
     DataViewDialog/DataViewDialog.cpp \
+    DbDiff/DbDiff.cpp \
+    DiffDialog/DiffDialog.cpp \
+    Exporter/Exporter.cpp \
+    ExportFilterDialog/ExportFilterDialog.cpp \
+    FileWriter/FileWriter.cpp \
+    FirebirdBackend/FirebirdBackend.cpp \
+    InflateContext/InflateContext.cpp \
+    InflateIndex/InflateIndex.cpp \
+    Inflater/Inflater.cpp \
+    PoolFileWriter/PoolFileWriter.cpp \
+    ProfileGridDialog/ProfileGridDialog.cpp \
+    ProfileGridModel/ProfileGridModel.cpp \
     ProfileItem/ProfileItem.cpp \
     ProfileModel/ProfileModel.cpp \
+    RecordCache/RecordCache.cpp \
+    RecordDiff/RecordDiff.cpp \
+    RecordDiffDialog/RecordDiffDialog.cpp \
+    RecordDevice/RecordDevice.cpp \
+    RecordLoader/RecordLoader.cpp \
+    Repacker/Repacker.cpp \
     TreeModel/TreeModel.cpp \
     main.cpp \
     MainWindow/MainWindow.cpp \
+    OdsBackend/OdsBackend.cpp \
+    OdsReader/OdsReader.cpp \
+    SqlBackend/SqlBackend.cpp \
     SqlCore/SqlCore.cpp \
-    TreeItem/TreeItem.cpp
+    SqliteBackend/SqliteBackend.cpp \
+    SqliteConverter/SqliteConverter.cpp \
+    Tracer/Tracer.cpp \
+    TreeItem/TreeItem.cpp \
+    Verifier/Verifier.cpp \
+    Workspace/Workspace.cpp \
+    ZlibInflater/ZlibInflater.cpp
 
 HEADERS += \
+    BatchPipeline/BatchPipeline.h \
+    CatalogCache/CatalogCache.h \
+    CatalogWriter/CatalogWriter.h \
+    Console/Console.h \
     DataViewDialog/DataViewDialog.h \
+    DbDiff/DbDiff.h \
+    DiffDialog/DiffDialog.h \
+    Exporter/Exporter.h \
+    ExportFilterDialog/ExportFilterDialog.h \
+    FileWriter/FileWriter.h \
+    FirebirdBackend/FirebirdBackend.h \
+    InflateContext/InflateContext.h \
+    InflateIndex/InflateIndex.h \
+    Inflater/Inflater.h \
     MainWindow/MainWindow.h \
+    OdsBackend/OdsBackend.h \
+    OdsReader/OdsReader.h \
+    PoolFileWriter/PoolFileWriter.h \
+    ProfileGridDialog/ProfileGridDialog.h \
+    ProfileGridModel/ProfileGridModel.h \
     ProfileItem/ProfileItem.h \
     ProfileModel/ProfileModel.h \
+    RecordCache/RecordCache.h \
+    RecordDiff/RecordDiff.h \
+    RecordDiffDialog/RecordDiffDialog.h \
+    RecordDevice/RecordDevice.h \
+    RecordLoader/RecordLoader.h \
+    Repacker/Repacker.h \
+    SqlBackend/SqlBackend.h \
     SqlCore/SqlCore.h \
+    SqliteBackend/SqliteBackend.h \
+    SqliteConverter/SqliteConverter.h \
+    StorageBackend/StorageBackend.h \
+    Tracer/Tracer.h \
     TreeItem/TreeItem.h \
-    TreeModel/TreeModel.h
+    TreeModel/TreeModel.h \
+    Verifier/Verifier.h \
+    Workspace/Workspace.h \
+    ZlibInflater/ZlibInflater.h
+
+# Faster decompression with libdeflate: qmake CONFIG+=libdeflate
+libdeflate {
+    DEFINES += USE_LIBDEFLATE
+    SOURCES += LibdeflateInflater/LibdeflateInflater.cpp
+    HEADERS += LibdeflateInflater/LibdeflateInflater.h
+    LIBS += -ldeflate
+}
+
+# Batched export writes with io_uring (Linux 5.15+): qmake CONFIG+=liburing
+linux:liburing {
+    DEFINES += USE_LIBURING
+    SOURCES += UringFileWriter/UringFileWriter.cpp
+    HEADERS += UringFileWriter/UringFileWriter.h
+    LIBS += -luring
+}
+
+# Read-only filesystem mount with libfuse 3: qmake CONFIG+=fuse
+unix:fuse {
+    DEFINES += USE_FUSE
+    SOURCES += FuseMount/FuseMount.cpp
+    HEADERS += FuseMount/FuseMount.h
+    CONFIG += link_pkgconfig
+    PKGCONFIG += fuse3
+}
 
 FORMS += \
     DataViewDialog/DataViewDialog.ui \
-    MainWindow/MainWindow.ui
+    DiffDialog/DiffDialog.ui \
+    ExportFilterDialog/ExportFilterDialog.ui \
+    MainWindow/MainWindow.ui \
+    ProfileGridDialog/ProfileGridDialog.ui \
+    RecordDiffDialog/RecordDiffDialog.ui
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -7,12 +7,21 @@
 ****************************************************************************/
 
 #include "MainWindow/MainWindow.h"
+#include "Console/Console.h"
+#include "Tracer/Tracer.h"
+#include "RecordCache/RecordCache.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
+    // Console commands run without GUI
+    if (Console::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return Console::exec(app);
+    }
+
     QApplication app(argc, argv);
     app.setWindowIcon(QIcon(":/icons/database.ico"));
 
@@ -20,11 +29,39 @@ int main(int argc, char *argv[])
     w.show();
 
     QCommandLineParser parser;
+    parser.addOption({ "user", "Firebird user name.", "name" });
+    parser.addOption({ "password", "Firebird password.", "password" });
+    parser.addOption({ "engine", "Database engine: auto, firebird or native.", "name", "auto" });
+    parser.addOption({ "inflate", "Decompression engine: " + Inflater::engines().join(", ") + ".", "name" });
+    parser.addOption({ "trace", "Write Chrome trace JSON to file.", "file" });
+    parser.addOption({ "cache-size", "Memory for inflated data shared by all open databases.", "MiB",
+                       QString::number(RecordCache::DEFAULT_BUDGET) });
     parser.process(app);
 
-    QStringList args = parser.positionalArguments();
-    if (!args.isEmpty())
-        w.open(args.first());
+    RecordCache::setBudget(parser.value("cache-size").toLongLong() * 1024 * 1024);
+
+    if (parser.isSet("trace"))
+        w.startTrace(parser.value("trace"));
+
+    if (parser.isSet("user"))
+        w.setCredentials(parser.value("user"), parser.value("password"));
+    w.setEngine(SqlCore::engineFromString(parser.value("engine")));
+    if (parser.isSet("inflate"))
+        w.setInflateEngine(parser.value("inflate"));
+
+    const QStringList args = parser.positionalArguments();
+    for (const QString &path : args)
+        w.open(path);
+
+    const int result = app.exec();
+
+    // Tracing left on until exit
+    if (Tracer::isEnabled()) {
+        QString errorMsg;
+        fputs(qPrintable(Tracer::finish(&errorMsg)), stderr);
+        if (!errorMsg.isEmpty())
+            fprintf(stderr, "Error: %s\n", qPrintable(errorMsg));
+    }
 
-    return app.exec();
+    return result;
 }